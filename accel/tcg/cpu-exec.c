@@ -45,7 +45,11 @@
 #include "exec/helper-proto.h"
 #include "tb-hash.h"
 #include "tb-context.h"
+#include "tb-prefetch.h"
 #include "internal.h"
+#ifdef CONFIG_FEAR5
+#include "fear5/faultinjection.h"
+#endif
 
 /* -icount align implementation. */
 
@@ -171,6 +175,16 @@ uint32_t curr_cflags(CPUState *cpu)
     return cflags;
 }
 
+/* Keep the code region of @tb from being evicted, see tb_evict() */
+static inline void tb_mark_used(TranslationBlock *tb)
+{
+    uint32_t epoch = qatomic_read(&tb_ctx.tb_evict_count);
+
+    if (unlikely(qatomic_read(&tb->lookup_epoch) != epoch)) {
+        qatomic_set(&tb->lookup_epoch, epoch);
+    }
+}
+
 /* Might cause an exception, so have a longjmp destination ready */
 static inline TranslationBlock *tb_lookup(CPUState *cpu, target_ulong pc,
                                           target_ulong cs_base,
@@ -187,10 +201,16 @@ static inline TranslationBlock *tb_lookup(CPUState *cpu, target_ulong pc,
 
     if (likely(tb &&
                tb->pc == pc &&
+#ifdef CONFIG_FEAR5
+               /* The jump cache only holds TBs valid for this mutant */
+               (tb->cs_base == cs_base || tb->cs_base == 0) &&
+#else
                tb->cs_base == cs_base &&
+#endif
                tb->flags == flags &&
                tb->trace_vcpu_dstate == *cpu->trace_dstate &&
                tb_cflags(tb) == cflags)) {
+        tb_mark_used(tb);
         return tb;
     }
     tb = tb_htable_lookup(cpu, pc, cs_base, flags, cflags);
@@ -198,6 +218,8 @@ static inline TranslationBlock *tb_lookup(CPUState *cpu, target_ulong pc,
         return NULL;
     }
     qatomic_set(&cpu->tb_jmp_cache[hash], tb);
+    tb_mark_used(tb);
+    tb_prefetch_hit(tb);
     return tb;
 }
 
@@ -301,15 +323,8 @@ static bool check_for_breakpoints(CPUState *cpu, target_ulong pc,
     return false;
 }
 
-/**
- * helper_lookup_tb_ptr: quick check for next tb
- * @env: current cpu state
- *
- * Look for an existing TB matching the current cpu state.
- * If found, return the code pointer.  If not found, return
- * the tcg epilogue so that we return into cpu_tb_exec.
- */
-const void *HELPER(lookup_tb_ptr)(CPUArchState *env)
+/* Look for an existing TB matching the current cpu state */
+static TranslationBlock *tb_lookup_current(CPUArchState *env)
 {
     CPUState *cpu = env_cpu(env);
     TranslationBlock *tb;
@@ -325,14 +340,74 @@ const void *HELPER(lookup_tb_ptr)(CPUArchState *env)
 
     tb = tb_lookup(cpu, pc, cs_base, flags, cflags);
     if (tb == NULL) {
-        return tcg_code_gen_epilogue;
+        return NULL;
     }
 
     log_cpu_exec(pc, cpu, tb);
 
+    return tb;
+}
+
+/**
+ * helper_lookup_tb_ptr: quick check for next tb
+ * @env: current cpu state
+ *
+ * Look for an existing TB matching the current cpu state.
+ * If found, return the code pointer.  If not found, return
+ * the tcg epilogue so that we return into cpu_tb_exec.
+ */
+const void *HELPER(lookup_tb_ptr)(CPUArchState *env)
+{
+    TranslationBlock *tb = tb_lookup_current(env);
+
+    return tb ? tb->tc.ptr : tcg_code_gen_epilogue;
+}
+
+/*
+ * helper_lookup_tb_ptr_ret: lookup_tb_ptr for a return that was not
+ * predicted by translator_ras_return(); predict the TB found next time
+ * if the return went to the pushed address
+ */
+const void *HELPER(lookup_tb_ptr_ret)(CPUArchState *env)
+{
+    CPUState *cpu = env_cpu(env);
+    /* the generated code has popped the entry already */
+    CPUTBRasEntry *e = &cpu->tb_ras[(cpu->tb_ras_top + 1) % TB_RAS_SIZE];
+    TranslationBlock *tb = tb_lookup_current(env);
+
+    if (tb == NULL) {
+        cpu->tb_ras_misses++;
+        return tcg_code_gen_epilogue;
+    }
+    if (tb->pc != e->ret_pc) {
+        cpu->tb_ras_mispredicts++;
+    } else {
+        cpu->tb_ras_misses++;
+        qatomic_set(&e->tb, tb);
+    }
     return tb->tc.ptr;
 }
 
+/* Report the return predictions of every vCPU */
+void tb_ras_report(void)
+{
+    CPUState *cpu;
+
+    CPU_FOREACH(cpu) {
+        trace_tb_ras_stats(cpu->cpu_index, cpu->tb_ras_hits,
+                           cpu->tb_ras_mispredicts, cpu->tb_ras_misses);
+    }
+}
+
+/**
+ * helper_tb_hot: promote a TB to a superblock
+ * @tb: TB that just reached tb_hot_threshold executions
+ */
+void HELPER(tb_hot)(void *tb)
+{
+    tb_mark_hot(tb);
+}
+
 /* Execute a TB, and fix up the CPU state afterwards if necessary */
 /*
  * Disable CFI checks.
@@ -528,6 +603,7 @@ TranslationBlock *tb_htable_lookup(CPUState *cpu, target_ulong pc,
                                    target_ulong cs_base, uint32_t flags,
                                    uint32_t cflags)
 {
+    TranslationBlock *tb;
     tb_page_addr_t phys_pc;
     struct tb_desc desc;
     uint32_t h;
@@ -544,7 +620,18 @@ TranslationBlock *tb_htable_lookup(CPUState *cpu, target_ulong pc,
     }
     desc.phys_page1 = phys_pc & TARGET_PAGE_MASK;
     h = tb_hash_func(phys_pc, pc, flags, cflags, *cpu->trace_dstate);
-    return qht_lookup_custom(&tb_ctx.htable, &desc, h, tb_lookup_cmp);
+    tb = qht_lookup_custom(&tb_ctx.htable, &desc, h, tb_lookup_cmp);
+#ifdef CONFIG_FEAR5
+    if (tb == NULL && cs_base != 0) {
+        /* Reuse the shared translation if the fault does not touch it */
+        desc.cs_base = 0;
+        tb = qht_lookup_custom(&tb_ctx.htable, &desc, h, tb_lookup_cmp);
+        if (tb && fear5_tb_affected(tb->pc, tb->size, tb->f5_gpr_mask)) {
+            tb = NULL;
+        }
+    }
+#endif
+    return tb;
 }
 
 void tb_set_jmp_target(TranslationBlock *tb, int n, uintptr_t addr)
@@ -42,6 +42,7 @@
 #include "tcg/tcg-ldst.h"
 #ifdef CONFIG_FEAR5
 #include "fear5/faultinjection.h"
+#include "fear5/taint.h"
 #endif
 
 /* DEBUG defines, enable DEBUG_TLB_LOG to log to the CPU_LOG_MMU target */
@@ -116,6 +117,7 @@ static void tb_flush_jmp_cache(CPUState *cpu, target_ulong addr)
        overlap the flushed page.  */
     tb_jmp_cache_clear_page(cpu, addr - TARGET_PAGE_SIZE);
     tb_jmp_cache_clear_page(cpu, addr);
+    cpu_tb_ras_clear(cpu);
 }
 
 /**
@@ -1184,6 +1186,16 @@ void tlb_set_page_with_attrs(CPUState *cpu, target_ulong vaddr,
 
     wp_flags = cpu_watchpoint_address_matches(cpu, vaddr_page,
                                               TARGET_PAGE_SIZE);
+#ifdef CONFIG_FEAR5
+    /*
+     * Like a watchpoint, force all data accesses to the page holding
+     * the faulty memory cell into the slow path.  All other pages keep
+     * using the inline TLB fast path.
+     */
+    if (unlikely(fear5_dmem_page_matches(vaddr_page))) {
+        wp_flags |= BP_MEM_READ | BP_MEM_WRITE;
+    }
+#endif
 
     index = tlb_index(env, mmu_idx, vaddr_page);
     te = tlb_entry(env, mmu_idx, vaddr_page);
@@ -1970,12 +1982,29 @@ load_helper(CPUArchState *env, target_ulong addr, MemOpIdx oi,
 
         /* Handle I/O access.  */
         if (likely(tlb_addr & TLB_MMIO)) {
+#ifdef CONFIG_FEAR5
+            /* Apply DMEM faults to data loads from MMIO-backed cells */
+            if (!code_read) {
+                res = io_readx(env, iotlbentry, mmu_idx, addr, retaddr,
+                               access_type, op ^ (need_swap * MO_BSWAP));
+                return fear5_mutate_memop(addr, res, op);
+            }
+#endif
             return io_readx(env, iotlbentry, mmu_idx, addr, retaddr,
                             access_type, op ^ (need_swap * MO_BSWAP));
         }
 
         haddr = (void *)((uintptr_t)addr + entry->addend);
 
+#ifdef CONFIG_FEAR5
+        /* Apply DMEM faults to data loads from the watched page */
+        if (!code_read) {
+            res = need_swap ? load_memop(haddr, op ^ MO_BSWAP)
+                            : load_memop(haddr, op);
+            return fear5_mutate_memop(addr, res, op);
+        }
+#endif
+
         /*
          * Keep these two load_memop separate to ensure that the compiler
          * is able to fold the entire function to a single instruction.
@@ -2314,6 +2343,35 @@ store_helper_unaligned(CPUArchState *env, target_ulong addr, uint64_t val,
     }
 }
 
+#ifdef CONFIG_FEAR5
+/*
+ * Apply the DMEM fault to a store, then compare it with the output
+ * monitor of the cell.  A fault on a monitored cell is therefore seen as
+ * a deviation.  Called right before the store, after any watchpoint trap,
+ * once per store.  Stores split into bytes get here once per byte.
+ */
+static inline uint64_t fear5_store(CPUArchState *env, target_ulong addr,
+                                   uint64_t val, MemOp op, uintptr_t retaddr)
+{
+    uint64_t res = fear5_mutate_memop(addr, val, op);
+    MemMonitor *mon = fear5_get_monitor(addr);
+
+    if (mon) {
+        if (f5->phase == MUTANT && fear5_taint_enabled() &&
+            (fear5_taint.st || res != val)) {
+            fear5_taint_monitor_store(env_cpu(env), addr, retaddr);
+        }
+        if (f5->phase == GOLDEN_RUN) {
+            mon->data[mon->pos++] = res;
+        }
+        else if (f5->phase == MUTANT && mon->data[mon->pos++] != res) {
+            fear5_kill_mutant(OUTPUT_DEVIATION);
+        }
+    }
+    return res;
+}
+#endif
+
 static inline void QEMU_ALWAYS_INLINE
 store_helper(CPUArchState *env, target_ulong addr, uint64_t val,
              MemOpIdx oi, uintptr_t retaddr, MemOp op)
@@ -2327,18 +2385,6 @@ store_helper(CPUArchState *env, target_ulong addr, uint64_t val,
     void *haddr;
     size_t size = memop_size(op);
 
-#ifdef CONFIG_FEAR5
-    MemMonitor *mon = fear5_get_monitor(addr);
-    if (mon) {
-        if (f5->phase == GOLDEN_RUN) {
-            mon->data[mon->pos++] = val;
-        }
-        else if (f5->phase == MUTANT && mon->data[mon->pos++] != val) {
-            fear5_kill_mutant(OUTPUT_DEVIATION);
-        }
-    }
-#endif
-
     /* Handle CPU specific unaligned behaviour */
     if (addr & ((1 << a_bits) - 1)) {
         cpu_unaligned_access(env_cpu(env), addr, MMU_DATA_STORE,
@@ -2376,6 +2422,11 @@ store_helper(CPUArchState *env, target_ulong addr, uint64_t val,
                                  iotlbentry->attrs, BP_MEM_WRITE, retaddr);
         }
 
+#ifdef CONFIG_FEAR5
+        /* DMEM faults and monitors, also for MMIO-backed cells */
+        val = fear5_store(env, addr, val, op, retaddr);
+#endif
+
         need_swap = size > 1 && (tlb_addr & TLB_BSWAP);
 
         /* Handle I/O access.  */
@@ -2420,6 +2471,10 @@ store_helper(CPUArchState *env, target_ulong addr, uint64_t val,
         return;
     }
 
+#ifdef CONFIG_FEAR5
+    val = fear5_store(env, addr, val, op, retaddr);
+#endif
+
     haddr = (void *)((uintptr_t)addr + entry->addend);
     store_memop(haddr, val, op);
 }
@@ -0,0 +1,282 @@
+/*
+ * Export of translated code to the Linux perf tool
+ *
+ * Copyright (c) 2022 Paderborn University, DE
+ *
+ * SPDX-License-Identifier: GPL-2.0-or-later
+ */
+
+#include "qemu/osdep.h"
+#include "qemu/error-report.h"
+#include "elf.h"
+#include "cpu.h"
+#include "disas/disas.h"
+#include "exec/exec-all.h"
+#include "tcg/tcg.h"
+#include "perf.h"
+
+/*
+ * perf attributes samples in code_gen_buffer to TBs by one of two files,
+ * written as TBs are translated:
+ *
+ * - /tmp/perf-<pid>.map, one "start size name" line per TB, which
+ *   perf report reads as is.  It cannot describe code that is replaced,
+ *   so samples in regions that were evicted or flushed may be attributed
+ *   to an earlier TB.
+ *
+ * - /tmp/jit-<pid>.dump in the jitdump format, which also holds the host
+ *   code and a timestamp for every TB.  perf inject --jit turns it into
+ *   one ELF image per TB, so perf annotate works and reused code is
+ *   told apart by time.  Record with "perf record -k 1".
+ *
+ * A TB is named by its guest pc and the guest ELF symbol containing it,
+ * if known (see lookup_symbol()).  Children forked by the guest keep the
+ * files of their parent and report nothing.  The files are buffered and
+ * only flushed at exit and before a fork, so perf reads them after the
+ * run.
+ */
+
+#define JITDUMP_MAGIC       0x4A695444      /* "JiTD" */
+#define JITDUMP_VERSION     1
+#define JIT_CODE_LOAD       0
+
+typedef struct JitdumpHeader {
+    uint32_t magic;
+    uint32_t version;
+    uint32_t total_size;
+    uint32_t elf_mach;
+    uint32_t pad1;
+    uint32_t pid;
+    uint64_t timestamp;
+    uint64_t flags;
+} JitdumpHeader;
+
+typedef struct JitdumpCodeLoad {
+    uint32_t id;
+    uint32_t total_size;
+    uint64_t timestamp;
+    uint32_t pid;
+    uint32_t tid;
+    uint64_t vma;
+    uint64_t code_addr;
+    uint64_t code_size;
+    uint64_t code_index;
+    /* followed by the name and the code */
+} JitdumpCodeLoad;
+
+static struct {
+    bool map_enabled;
+    bool jitdump_enabled;
+    pid_t pid;
+    FILE *map;
+    FILE *jitdump;
+    void *marker;
+    uint64_t code_index;
+} perf;
+
+void perf_set_map_enabled(bool enabled)
+{
+    perf.map_enabled = enabled;
+}
+
+bool perf_get_map_enabled(void)
+{
+    return perf.map_enabled;
+}
+
+void perf_set_jitdump_enabled(bool enabled)
+{
+    perf.jitdump_enabled = enabled;
+}
+
+bool perf_get_jitdump_enabled(void)
+{
+    return perf.jitdump_enabled;
+}
+
+bool perf_enabled(void)
+{
+    return perf.map_enabled || perf.jitdump_enabled;
+}
+
+static uint64_t perf_timestamp(void)
+{
+    struct timespec ts;
+
+    /* the clock of "perf record -k 1" */
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec * 1000000000ULL + ts.tv_nsec;
+}
+
+/* e_machine of the host, from our own ELF header */
+static uint16_t perf_host_machine(void)
+{
+    uint16_t machine = EM_NONE;
+    unsigned char ident[EI_NIDENT + 4];
+    int fd = open("/proc/self/exe", O_RDONLY);
+
+    if (fd >= 0) {
+        if (read(fd, ident, sizeof(ident)) == sizeof(ident)) {
+            memcpy(&machine, ident + EI_NIDENT + 2, sizeof(machine));
+        }
+        close(fd);
+    }
+    return machine;
+}
+
+static FILE *perf_open(const char *fmt)
+{
+    g_autofree char *path = g_strdup_printf(fmt, (int)perf.pid);
+    /* readable, so that it can be mapped */
+    FILE *f = fopen(path, "w+");
+
+    if (f == NULL) {
+        warn_report("Could not open %s: %s, not writing it", path,
+                    strerror(errno));
+    }
+    return f;
+}
+
+static void perf_jitdump_open(void)
+{
+    JitdumpHeader h = {
+        .magic = JITDUMP_MAGIC,
+        .version = JITDUMP_VERSION,
+        .total_size = sizeof(h),
+        .elf_mach = perf_host_machine(),
+        .pid = perf.pid,
+        .timestamp = perf_timestamp(),
+    };
+
+    perf.jitdump = perf_open("/tmp/jit-%d.dump");
+    if (perf.jitdump == NULL) {
+        return;
+    }
+    /* perf record finds the file by this executable mapping of it */
+    perf.marker = mmap(NULL, qemu_real_host_page_size, PROT_READ | PROT_EXEC,
+                       MAP_PRIVATE, fileno(perf.jitdump), 0);
+    if (perf.marker == MAP_FAILED) {
+        warn_report("Could not map the jitdump file: %s, not writing it",
+                    strerror(errno));
+        fclose(perf.jitdump);
+        perf.jitdump = NULL;
+        return;
+    }
+    fwrite(&h, sizeof(h), 1, perf.jitdump);
+    fflush(perf.jitdump);
+}
+
+/* Called at exit and by preexit_cleanup(), which bypasses atexit() */
+void perf_exit(void)
+{
+    if (perf.map) {
+        fflush(perf.map);
+    }
+    if (perf.jitdump) {
+        fflush(perf.jitdump);
+    }
+}
+
+/*
+ * Empty the buffers before a fork, so that the child does not write them
+ * to the files a second time when it exits.
+ */
+static void perf_fork_prepare(void)
+{
+    if (perf.map) {
+        flockfile(perf.map);
+        fflush(perf.map);
+    }
+    if (perf.jitdump) {
+        flockfile(perf.jitdump);
+        fflush(perf.jitdump);
+    }
+}
+
+static void perf_fork_parent(void)
+{
+    if (perf.map) {
+        funlockfile(perf.map);
+    }
+    if (perf.jitdump) {
+        funlockfile(perf.jitdump);
+    }
+}
+
+static void perf_fork_child(void)
+{
+    perf_fork_parent();
+    /* the files are named after the parent, stop reporting */
+    perf.map = NULL;
+    perf.jitdump = NULL;
+}
+
+void perf_init(void)
+{
+    if (!perf_enabled()) {
+        return;
+    }
+#ifdef CONFIG_TCG_INTERPRETER
+    warn_report("perf-map and jitdump need native code, disabling them");
+    perf.map_enabled = perf.jitdump_enabled = false;
+    return;
+#endif
+    perf.pid = getpid();
+    if (perf.map_enabled) {
+        perf.map = perf_open("/tmp/perf-%d.map");
+    }
+    if (perf.jitdump_enabled) {
+        perf_jitdump_open();
+    }
+    atexit(perf_exit);
+    pthread_atfork(perf_fork_prepare, perf_fork_parent, perf_fork_child);
+}
+
+static void perf_jitdump_write(const TranslationBlock *tb, const char *name)
+{
+    size_t name_size = strlen(name) + 1;
+    JitdumpCodeLoad r = {
+        .id = JIT_CODE_LOAD,
+        .total_size = sizeof(r) + name_size + tb->tc.size,
+        .timestamp = perf_timestamp(),
+        .pid = perf.pid,
+        .tid = qemu_get_thread_id(),
+        .vma = (uintptr_t)tb->tc.ptr,
+        .code_addr = (uintptr_t)tb->tc.ptr,
+        .code_size = tb->tc.size,
+    };
+
+    /* records of concurrent translations must not interleave */
+    flockfile(perf.jitdump);
+    r.code_index = perf.code_index++;
+    fwrite(&r, sizeof(r), 1, perf.jitdump);
+    fwrite(name, name_size, 1, perf.jitdump);
+    fwrite(tb->tc.ptr, tb->tc.size, 1, perf.jitdump);
+    funlockfile(perf.jitdump);
+}
+
+void perf_report_tb(const TranslationBlock *tb)
+{
+    g_autofree char *name = NULL;
+    const char *symbol;
+
+    if (!(perf.map || perf.jitdump)) {
+        return;
+    }
+
+    symbol = lookup_symbol(tb->pc);
+    if (symbol[0]) {
+        name = g_strdup_printf("%s@0x" TARGET_FMT_lx, symbol, tb->pc);
+    } else {
+        name = g_strdup_printf("0x" TARGET_FMT_lx, tb->pc);
+    }
+
+    if (perf.map) {
+        /* fprintf() locks the stream, lines do not interleave */
+        fprintf(perf.map, "%" PRIxPTR " %zx %s\n",
+                (uintptr_t)tb->tc.ptr, tb->tc.size, name);
+    }
+    if (perf.jitdump) {
+        perf_jitdump_write(tb, name);
+    }
+}
@@ -0,0 +1,42 @@
+/*
+ * Export of translated code to the Linux perf tool
+ *
+ * Copyright (c) 2022 Paderborn University, DE
+ *
+ * SPDX-License-Identifier: GPL-2.0-or-later
+ */
+
+#ifndef ACCEL_TCG_PERF_H
+#define ACCEL_TCG_PERF_H
+
+#include "exec/exec-all.h"
+
+#ifdef CONFIG_LINUX
+void perf_set_map_enabled(bool enabled);
+bool perf_get_map_enabled(void);
+void perf_set_jitdump_enabled(bool enabled);
+bool perf_get_jitdump_enabled(void);
+bool perf_enabled(void);
+void perf_init(void);
+void perf_exit(void);
+void perf_report_tb(const TranslationBlock *tb);
+#else
+static inline bool perf_enabled(void)
+{
+    return false;
+}
+
+static inline void perf_init(void)
+{
+}
+
+static inline void perf_exit(void)
+{
+}
+
+static inline void perf_report_tb(const TranslationBlock *tb)
+{
+}
+#endif
+
+#endif /* ACCEL_TCG_PERF_H */
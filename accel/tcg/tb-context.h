@@ -34,6 +34,9 @@ struct TBContext {
 
     /* statistics */
     unsigned tb_flush_count;
+    unsigned tb_evict_count;
+    unsigned tb_prefetch_count;
+    unsigned tb_prefetch_hits;
     unsigned tb_phys_invalidate_count;
 };
 
@@ -0,0 +1,246 @@
+/*
+ * Translation of predicted successor TBs in a helper thread
+ *
+ * Copyright (c) 2022 Paderborn University, DE
+ *
+ * SPDX-License-Identifier: GPL-2.0-or-later
+ */
+
+#include "qemu/osdep.h"
+#include "qemu/rcu.h"
+#include "qemu/thread.h"
+#include "cpu.h"
+#include "exec/exec-all.h"
+#include "exec/cpu_ldst.h"
+#include "tcg/tcg.h"
+#include "internal.h"
+#include "tb-prefetch.h"
+#include "trace.h"
+#ifdef CONFIG_FEAR5
+#include "qemu/log.h"
+#include "fear5/faultinjection.h"
+#endif
+
+/*
+ * When a vCPU translates a TB, the destinations of its goto_tb exits are
+ * queued (see translator_use_goto_tb()) and translated by a helper thread
+ * with the cs_base, flags and cflags of that TB.  If the vCPU gets there
+ * with the same state, it finds the TB in tb_ctx.htable instead of having
+ * to stop and translate it.
+ *
+ * This is only done for user mode emulation: guest code is in host
+ * memory and all translation is serialised with mmap_lock(), so the
+ * helper can share the one TCG context with the vCPUs.  In system mode,
+ * reading guest code goes through the softmmu TLB of a vCPU, which other
+ * threads must not touch.
+ *
+ * The helper does not translate with the vCPU, which keeps running and
+ * changing its state, but with a private CPU of the same type.  Queue
+ * entries only hold the key of the TB.  Like a TB that one vCPU
+ * translated and another one finds, the translation may depend on that
+ * key and on the CPU model, which the private CPU gets from the -cpu
+ * options like every vCPU, but not on the rest of the vCPU state.
+ *
+ * The helper never raises guest exceptions: it only translates code on
+ * pages that are mapped executable, together with the page after them,
+ * and gives up if the code buffer is full rather than making room.
+ */
+
+#define TB_PREFETCH_QUEUE_SIZE  256     /* entries, power of 2 */
+#define TB_PREFETCH_DEPTH       2       /* successors of successors */
+
+typedef struct TBPrefetchEntry {
+    unsigned long trace_dstate;
+    target_ulong pc;
+    target_ulong cs_base;
+    uint32_t flags;
+    uint32_t cflags;
+    int depth;
+} TBPrefetchEntry;
+
+static struct {
+    bool enabled;
+    QemuThread thread;
+    QemuMutex lock;
+    QemuCond cond;
+    CPUState *cpu;              /* private to the helper thread */
+    /* protected by lock */
+    const char *cpu_type;       /* of the vCPUs */
+    unsigned int head;
+    unsigned int tail;
+    TBPrefetchEntry queue[TB_PREFETCH_QUEUE_SIZE];
+} tbp;
+
+/* Depth of the TB the helper translates, 0 on vCPU threads */
+static __thread int tb_prefetch_depth;
+
+void tb_prefetch_set_enabled(bool enabled)
+{
+    tbp.enabled = enabled;
+}
+
+bool tb_prefetch_get_enabled(void)
+{
+    return tbp.enabled;
+}
+
+bool tb_prefetch_in_progress(void)
+{
+    return tb_prefetch_depth != 0;
+}
+
+void tb_prefetch_queue(CPUState *cpu, const TranslationBlock *tb,
+                       target_ulong pc)
+{
+    uint32_t cflags = tb_cflags(tb);
+    TBPrefetchEntry *e;
+
+    if (!qatomic_read(&tbp.enabled) ||
+        tb_prefetch_depth >= TB_PREFETCH_DEPTH ||
+        (cflags & (CF_COUNT_MASK | CF_SINGLE_STEP | CF_LAST_IO |
+                   CF_MEMI_ONLY | CF_NOIRQ))) {
+        return;
+    }
+    /* Translation callbacks of plugins are made on the vCPU thread */
+    if (test_bit(QEMU_PLUGIN_EV_VCPU_TB_TRANS, cpu->plugin_mask)) {
+        return;
+    }
+#ifdef CONFIG_FEAR5
+    /*
+     * Translations with fault hooks are made for the current mutant, and
+     * golden run statistics are collected while translating.
+     */
+    if (tb->cs_base != 0 || f5->phase == MUTANT ||
+        qemu_loglevel_mask(FEAR5_LOG_GOLDENRUN)) {
+        return;
+    }
+#endif
+
+    qemu_mutex_lock(&tbp.lock);
+    if (tbp.tail - tbp.head < TB_PREFETCH_QUEUE_SIZE) {
+        if (!tbp.cpu_type) {
+            tbp.cpu_type = object_get_typename(OBJECT(cpu));
+        }
+        e = &tbp.queue[tbp.tail++ % TB_PREFETCH_QUEUE_SIZE];
+        e->trace_dstate = *cpu->trace_dstate;
+        e->pc = pc;
+        e->cs_base = tb->cs_base;
+        e->flags = tb->flags;
+        e->cflags = cflags;
+        e->depth = tb_prefetch_depth + 1;
+        qemu_cond_signal(&tbp.cond);
+    }
+    qemu_mutex_unlock(&tbp.lock);
+}
+
+/* Can the code at @pc be read without faulting?  Call with mmap_lock held */
+static bool tb_prefetch_page_ok(target_ulong pc)
+{
+    target_ulong page = pc & TARGET_PAGE_MASK;
+    int need = PAGE_READ | PAGE_EXEC;
+
+    /* the last instruction may continue on the next page */
+    return guest_addr_valid_untagged(page) &&
+           guest_addr_valid_untagged(page + TARGET_PAGE_SIZE) &&
+           (page_get_flags(page) & need) == need &&
+           (page_get_flags(page + TARGET_PAGE_SIZE) & need) == need;
+}
+
+/* The private CPU, set up for the TB key of @e */
+static CPUState *tb_prefetch_cpu(const TBPrefetchEntry *e)
+{
+    if (!tbp.cpu) {
+        tbp.cpu = cpu_create(tbp.cpu_type);
+        cpu_reset(tbp.cpu);
+        /* not a vCPU: exclusive sections and the guest must not see it */
+        cpu_list_remove(tbp.cpu);
+    }
+    *tbp.cpu->trace_dstate = e->trace_dstate;
+    return tbp.cpu;
+}
+
+static void tb_prefetch_one(const TBPrefetchEntry *e)
+{
+    CPUState *cpu = tb_prefetch_cpu(e);
+    TranslationBlock *tb;
+
+    mmap_lock();
+    if (tb_prefetch_page_ok(e->pc) &&
+        !tb_htable_lookup(cpu, e->pc, e->cs_base, e->flags, e->cflags)) {
+        tb_prefetch_depth = e->depth;
+        tb = tb_gen_code(cpu, e->pc, e->cs_base, e->flags, e->cflags);
+        tb_prefetch_depth = 0;
+        qemu_thread_jit_execute();
+        if (tb) {
+            /* no vCPU can have translated it, mmap_lock is held */
+            qatomic_set(&tb->prefetched, true);
+            qatomic_inc(&tb_ctx.tb_prefetch_count);
+            trace_tb_prefetch_translate(tb, e->pc, e->depth);
+        }
+    }
+    mmap_unlock();
+}
+
+static void *tb_prefetch_thread(void *arg)
+{
+    rcu_register_thread();
+    tcg_register_thread();
+
+    while (true) {
+        TBPrefetchEntry e;
+
+        qemu_mutex_lock(&tbp.lock);
+        while (tbp.head == tbp.tail) {
+            qemu_cond_wait(&tbp.cond, &tbp.lock);
+        }
+        e = tbp.queue[tbp.head++ % TB_PREFETCH_QUEUE_SIZE];
+        qemu_mutex_unlock(&tbp.lock);
+
+        WITH_RCU_READ_LOCK_GUARD() {
+            tb_prefetch_one(&e);
+        }
+    }
+    return NULL;
+}
+
+/* Called at exit and by preexit_cleanup(), which bypasses atexit() */
+void tb_prefetch_exit(void)
+{
+    if (!qatomic_xchg(&tbp.enabled, false)) {
+        return;
+    }
+    trace_tb_prefetch_stats(qatomic_read(&tb_ctx.tb_prefetch_count),
+                            qatomic_read(&tb_ctx.tb_prefetch_hits));
+}
+
+static void tb_prefetch_fork_prepare(void)
+{
+    qemu_mutex_lock(&tbp.lock);
+}
+
+static void tb_prefetch_fork_parent(void)
+{
+    qemu_mutex_unlock(&tbp.lock);
+}
+
+static void tb_prefetch_fork_child(void)
+{
+    /* The helper thread is not forked; the child translates on its own */
+    qatomic_set(&tbp.enabled, false);
+    qemu_mutex_init(&tbp.lock);
+    qemu_cond_init(&tbp.cond);
+}
+
+void tb_prefetch_init(void)
+{
+    if (!tbp.enabled) {
+        return;
+    }
+    qemu_mutex_init(&tbp.lock);
+    qemu_cond_init(&tbp.cond);
+    atexit(tb_prefetch_exit);
+    pthread_atfork(tb_prefetch_fork_prepare, tb_prefetch_fork_parent,
+                   tb_prefetch_fork_child);
+    qemu_thread_create(&tbp.thread, "tb-prefetch", tb_prefetch_thread,
+                       NULL, QEMU_THREAD_DETACHED);
+}
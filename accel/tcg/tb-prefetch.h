@@ -0,0 +1,52 @@
+/*
+ * Translation of predicted successor TBs in a helper thread
+ *
+ * Copyright (c) 2022 Paderborn University, DE
+ *
+ * SPDX-License-Identifier: GPL-2.0-or-later
+ */
+
+#ifndef ACCEL_TCG_TB_PREFETCH_H
+#define ACCEL_TCG_TB_PREFETCH_H
+
+#include "exec/exec-all.h"
+#include "tb-context.h"
+
+#ifdef CONFIG_USER_ONLY
+void tb_prefetch_set_enabled(bool enabled);
+bool tb_prefetch_get_enabled(void);
+void tb_prefetch_init(void);
+void tb_prefetch_queue(CPUState *cpu, const TranslationBlock *tb,
+                       target_ulong pc);
+bool tb_prefetch_in_progress(void);
+void tb_prefetch_exit(void);
+
+/* Count the first lookup of a TB that was translated ahead */
+static inline void tb_prefetch_hit(TranslationBlock *tb)
+{
+    if (unlikely(qatomic_read(&tb->prefetched))) {
+        qatomic_set(&tb->prefetched, false);
+        qatomic_inc(&tb_ctx.tb_prefetch_hits);
+    }
+}
+#else
+static inline void tb_prefetch_init(void)
+{
+}
+
+static inline void tb_prefetch_queue(CPUState *cpu, const TranslationBlock *tb,
+                                     target_ulong pc)
+{
+}
+
+static inline bool tb_prefetch_in_progress(void)
+{
+    return false;
+}
+
+static inline void tb_prefetch_hit(TranslationBlock *tb)
+{
+}
+#endif
+
+#endif /* ACCEL_TCG_TB_PREFETCH_H */
@@ -37,6 +37,8 @@
 #include "hw/boards.h"
 #endif
 #include "internal.h"
+#include "tb-prefetch.h"
+#include "perf.h"
 #ifdef CONFIG_FEAR5
 #include "fear5/faultinjection.h"
 #endif
@@ -47,6 +49,8 @@ struct TCGState {
     bool mttcg_enabled;
     int splitwx_enabled;
     unsigned long tb_size;
+    uint32_t hot_threshold;
+    bool cse_enabled;
 };
 typedef struct TCGState TCGState;
 
@@ -130,6 +134,8 @@ static int tcg_init_machine(MachineState *ms)
 
     tcg_allowed = true;
     mttcg_enabled = s->mttcg_enabled;
+    tb_hot_threshold = s->hot_threshold;
+    tcg_cse_enabled = s->cse_enabled;
 
 #ifdef CONFIG_FEAR5
     // Init data structures for golden run analysis:
@@ -148,6 +154,8 @@ static int tcg_init_machine(MachineState *ms)
     page_init();
     tb_htable_init();
     tcg_init(s->tb_size * MiB, s->splitwx_enabled, max_cpus);
+    tb_prefetch_init();
+    perf_init();
 
 #if defined(CONFIG_SOFTMMU)
     /*
@@ -219,6 +227,30 @@ static void tcg_set_tb_size(Object *obj, Visitor *v,
     s->tb_size = value;
 }
 
+static void tcg_get_hot_threshold(Object *obj, Visitor *v,
+                                  const char *name, void *opaque,
+                                  Error **errp)
+{
+    TCGState *s = TCG_STATE(obj);
+    uint32_t value = s->hot_threshold;
+
+    visit_type_uint32(v, name, &value, errp);
+}
+
+static void tcg_set_hot_threshold(Object *obj, Visitor *v,
+                                  const char *name, void *opaque,
+                                  Error **errp)
+{
+    TCGState *s = TCG_STATE(obj);
+    uint32_t value;
+
+    if (!visit_type_uint32(v, name, &value, errp)) {
+        return;
+    }
+
+    s->hot_threshold = value;
+}
+
 static bool tcg_get_splitwx(Object *obj, Error **errp)
 {
     TCGState *s = TCG_STATE(obj);
@@ -231,6 +263,52 @@ static void tcg_set_splitwx(Object *obj, bool value, Error **errp)
     s->splitwx_enabled = value;
 }
 
+static bool tcg_get_cse(Object *obj, Error **errp)
+{
+    TCGState *s = TCG_STATE(obj);
+    return s->cse_enabled;
+}
+
+static void tcg_set_cse(Object *obj, bool value, Error **errp)
+{
+    TCGState *s = TCG_STATE(obj);
+    s->cse_enabled = value;
+}
+
+#ifdef CONFIG_LINUX
+static bool tcg_get_perf_map(Object *obj, Error **errp)
+{
+    return perf_get_map_enabled();
+}
+
+static void tcg_set_perf_map(Object *obj, bool value, Error **errp)
+{
+    perf_set_map_enabled(value);
+}
+
+static bool tcg_get_jitdump(Object *obj, Error **errp)
+{
+    return perf_get_jitdump_enabled();
+}
+
+static void tcg_set_jitdump(Object *obj, bool value, Error **errp)
+{
+    perf_set_jitdump_enabled(value);
+}
+#endif
+
+#ifdef CONFIG_USER_ONLY
+static bool tcg_get_tb_prefetch(Object *obj, Error **errp)
+{
+    return tb_prefetch_get_enabled();
+}
+
+static void tcg_set_tb_prefetch(Object *obj, bool value, Error **errp)
+{
+    tb_prefetch_set_enabled(value);
+}
+#endif
+
 static void tcg_accel_class_init(ObjectClass *oc, void *data)
 {
     AccelClass *ac = ACCEL_CLASS(oc);
@@ -248,10 +326,40 @@ static void tcg_accel_class_init(ObjectClass *oc, void *data)
     object_class_property_set_description(oc, "tb-size",
         "TCG translation block cache size");
 
+    object_class_property_add(oc, "hot-threshold", "int",
+        tcg_get_hot_threshold, tcg_set_hot_threshold,
+        NULL, NULL);
+    object_class_property_set_description(oc, "hot-threshold",
+        "Executions after which a TB is retranslated as a superblock");
+
     object_class_property_add_bool(oc, "split-wx",
         tcg_get_splitwx, tcg_set_splitwx);
     object_class_property_set_description(oc, "split-wx",
         "Map jit pages into separate RW and RX regions");
+
+    object_class_property_add_bool(oc, "x-cse",
+        tcg_get_cse, tcg_set_cse);
+    object_class_property_set_description(oc, "x-cse",
+        "Debug: eliminate common subexpressions and dead env stores");
+
+#ifdef CONFIG_LINUX
+    object_class_property_add_bool(oc, "perf-map",
+        tcg_get_perf_map, tcg_set_perf_map);
+    object_class_property_set_description(oc, "perf-map",
+        "Name translated code for perf in /tmp/perf-<pid>.map");
+
+    object_class_property_add_bool(oc, "jitdump",
+        tcg_get_jitdump, tcg_set_jitdump);
+    object_class_property_set_description(oc, "jitdump",
+        "Write translated code for perf to /tmp/jit-<pid>.dump");
+#endif
+
+#ifdef CONFIG_USER_ONLY
+    object_class_property_add_bool(oc, "tb-prefetch",
+        tcg_get_tb_prefetch, tcg_set_tb_prefetch);
+    object_class_property_set_description(oc, "tb-prefetch",
+        "Translate the successors of new TBs in a helper thread");
+#endif
 }
 
 static const TypeInfo tcg_accel_type = {
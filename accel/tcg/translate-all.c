@@ -60,6 +60,8 @@
 #include "tb-hash.h"
 #include "tb-context.h"
 #include "internal.h"
+#include "tb-prefetch.h"
+#include "perf.h"
 
 /* #define DEBUG_TB_INVALIDATE */
 /* #define DEBUG_TB_FLUSH */
@@ -899,11 +901,38 @@ static bool tb_cmp(const void *ap, const void *bp)
         a->page_addr[1] == b->page_addr[1];
 }
 
+uint32_t tb_hot_threshold;
+
+/* Guest PCs of hot TBs, protected by tb_hot_lock */
+static GHashTable *tb_hot_pcs;
+static QemuMutex tb_hot_lock;
+
+/*
+ * Drop the PC of @tb from the hot PCs, or all of them if @tb is NULL.
+ * A PC only stays hot while translations of it are in the code buffer.
+ */
+static void tb_hot_forget(TranslationBlock *tb)
+{
+    uint64_t key;
+
+    qemu_mutex_lock(&tb_hot_lock);
+    if (tb) {
+        key = tb->pc;
+        g_hash_table_remove(tb_hot_pcs, &key);
+    } else {
+        g_hash_table_remove_all(tb_hot_pcs);
+    }
+    qemu_mutex_unlock(&tb_hot_lock);
+}
+
 void tb_htable_init(void)
 {
     unsigned int mode = QHT_MODE_AUTO_RESIZE;
 
     qht_init(&tb_ctx.htable, tb_cmp, CODE_GEN_HTABLE_SIZE, mode);
+    qemu_mutex_init(&tb_hot_lock);
+    tb_hot_pcs = g_hash_table_new_full(g_int64_hash, g_int64_equal,
+                                       g_free, NULL);
 }
 
 /* call with @p->lock held */
@@ -990,6 +1019,7 @@ static void do_tb_flush(CPUState *cpu, run_on_cpu_data tb_flush_count)
 
     qht_reset_size(&tb_ctx.htable, CODE_GEN_HTABLE_SIZE);
     page_flush_tb();
+    tb_hot_forget(NULL);
 
     tcg_region_reset_all();
     /* XXX: flush processor icache at this point if cache flush is
@@ -1164,6 +1194,48 @@ static inline void tb_jmp_unlink(TranslationBlock *dest)
     qemu_spin_unlock(&dest->jmp_lock);
 }
 
+static gboolean tb_unlink_iter(gpointer key, gpointer value, gpointer data)
+{
+    tb_jmp_unlink(value);
+    return false;
+}
+
+#ifdef CONFIG_FEAR5
+static void do_tb_unlink_all(CPUState *cpu, run_on_cpu_data data)
+{
+    mmap_lock();
+    CPU_FOREACH(cpu) {
+        cpu_tb_jmp_cache_clear(cpu);
+    }
+    qemu_thread_jit_write();
+    tcg_tb_foreach(tb_unlink_iter, NULL);
+    qemu_thread_jit_execute();
+    mmap_unlock();
+}
+
+/*
+ * Break all direct TB chains and clear the jump caches, but keep every
+ * translation.  FEAR5 uses this instead of tb_flush() when switching to
+ * the next mutant, so that chains can only be re-established through a
+ * lookup that honours the fault key of the new mutant.
+ */
+void tb_unlink_all(CPUState *cpu)
+{
+    if (tcg_enabled()) {
+        if (cpu_in_exclusive_context(cpu)) {
+            do_tb_unlink_all(cpu, RUN_ON_CPU_NULL);
+        } else {
+            async_safe_run_on_cpu(cpu, do_tb_unlink_all, RUN_ON_CPU_NULL);
+        }
+    }
+}
+
+unsigned tb_get_flush_count(void)
+{
+    return qatomic_read(&tb_ctx.tb_flush_count);
+}
+#endif
+
 /*
  * In user-mode, call with mmap_lock held.
  * In !user-mode, if @rm_from_page_list is set, call with the TB's pages'
@@ -1210,6 +1282,11 @@ static void do_tb_phys_invalidate(TranslationBlock *tb, bool rm_from_page_list)
         if (qatomic_read(&cpu->tb_jmp_cache[h]) == tb) {
             qatomic_set(&cpu->tb_jmp_cache[h], NULL);
         }
+        for (int i = 0; i < TB_RAS_SIZE; i++) {
+            if (qatomic_read(&cpu->tb_ras[i].tb) == tb) {
+                qatomic_set(&cpu->tb_ras[i].tb, NULL);
+            }
+        }
     }
 
     /* suppress this TB from the two jump lists */
@@ -1245,6 +1322,71 @@ void tb_phys_invalidate(TranslationBlock *tb, tb_page_addr_t page_addr)
     }
 }
 
+static gboolean tb_evict_iter(gpointer key, gpointer value, gpointer data)
+{
+    TranslationBlock *tb = value;
+
+    if (!(tb_cflags(tb) & CF_INVALID)) {
+        tb_phys_invalidate(tb, -1);
+    }
+    /* its PC starts counting again if it is translated once more */
+    tb_hot_forget(tb);
+    return false;
+}
+
+/* recycle the least recently used region of the code buffer */
+static void do_tb_evict(CPUState *cpu, run_on_cpu_data tb_flush_count)
+{
+    int victim;
+
+    mmap_lock();
+    /* A flush on request of another CPU has made room already */
+    if (tb_ctx.tb_flush_count != tb_flush_count.host_int) {
+        mmap_unlock();
+        return;
+    }
+
+    qemu_thread_jit_write();
+    victim = tcg_region_evict(tcg_ctx, tb_ctx.tb_evict_count,
+                              tb_evict_iter, tb_unlink_iter, NULL);
+    if (victim < 0) {
+        qemu_thread_jit_execute();
+        mmap_unlock();
+        do_tb_flush(cpu, tb_flush_count);
+        return;
+    }
+    /*
+     * Chained TBs are not looked up again, tcg_region_evict() has probed
+     * the next candidate by unlinking the jumps into it.  TBs predicted for
+     * returns are not looked up either, so drop the predictions.
+     */
+    CPU_FOREACH(cpu) {
+        cpu_tb_ras_clear(cpu);
+    }
+    qemu_thread_jit_execute();
+    qatomic_mb_set(&tb_ctx.tb_evict_count, tb_ctx.tb_evict_count + 1);
+    mmap_unlock();
+}
+
+/*
+ * Make room in a full code buffer by recycling the region that has gone
+ * unused for the longest time, and flush the whole buffer only if there
+ * is no such region.
+ */
+void tb_evict(CPUState *cpu)
+{
+    if (tcg_enabled()) {
+        unsigned tb_flush_count = qatomic_mb_read(&tb_ctx.tb_flush_count);
+
+        if (cpu_in_exclusive_context(cpu)) {
+            do_tb_evict(cpu, RUN_ON_CPU_HOST_INT(tb_flush_count));
+        } else {
+            async_safe_run_on_cpu(cpu, do_tb_evict,
+                                  RUN_ON_CPU_HOST_INT(tb_flush_count));
+        }
+    }
+}
+
 #ifdef CONFIG_SOFTMMU
 /* call with @p->lock held */
 static void build_page_bitmap(PageDesc *p)
@@ -1377,7 +1519,53 @@ tb_link_page(TranslationBlock *tb, tb_page_addr_t phys_pc,
     return tb;
 }
 
-/* Called with mmap_lock held for user mode emulation.  */
+/*
+ * Tiered translation: TBs first count their executions, see gen_tb_count().
+ * Once a TB has run tb_hot_threshold times, its PC is recorded as hot and
+ * the TB is invalidated, so that the next lookup translates it again as a
+ * superblock that continues across direct branches.
+ */
+static uint8_t tb_tier(target_ulong pc, uint32_t cflags)
+{
+    uint64_t key = pc;
+    bool hot;
+
+    if (!tb_hot_threshold ||
+        (cflags & (CF_COUNT_MASK | CF_SINGLE_STEP | CF_LAST_IO |
+                   CF_USE_ICOUNT | CF_NOIRQ))) {
+        return TB_TIER_NONE;
+    }
+#ifdef CONFIG_FEAR5
+    /* golden run statistics assume that TBs are left at their end */
+    if (qemu_loglevel_mask(FEAR5_LOG_GOLDENRUN)) {
+        return TB_TIER_NONE;
+    }
+#endif
+
+    qemu_mutex_lock(&tb_hot_lock);
+    hot = g_hash_table_contains(tb_hot_pcs, &key);
+    qemu_mutex_unlock(&tb_hot_lock);
+    return hot ? TB_TIER_SUPERBLOCK : TB_TIER_COUNT;
+}
+
+/* Called from the code of @tb, which keeps running until it is left */
+void tb_mark_hot(TranslationBlock *tb)
+{
+    uint64_t key = tb->pc;
+
+    qemu_mutex_lock(&tb_hot_lock);
+    g_hash_table_add(tb_hot_pcs, g_memdup2(&key, sizeof(key)));
+    qemu_mutex_unlock(&tb_hot_lock);
+
+    mmap_lock();
+    tb_phys_invalidate(tb, -1);
+    mmap_unlock();
+}
+
+/*
+ * Called with mmap_lock held for user mode emulation.  Only returns NULL
+ * when translating ahead (see tb-prefetch.c) into a full code buffer.
+ */
 TranslationBlock *tb_gen_code(CPUState *cpu,
                               target_ulong pc, target_ulong cs_base,
                               uint32_t flags, int cflags)
@@ -1412,8 +1600,12 @@ TranslationBlock *tb_gen_code(CPUState *cpu,
  buffer_overflow:
     tb = tcg_tb_alloc(tcg_ctx);
     if (unlikely(!tb)) {
-        /* flush must be done */
-        tb_flush(cpu);
+        if (tb_prefetch_in_progress()) {
+            /* leave making room to the vCPU */
+            return NULL;
+        }
+        /* eviction or flush must be done */
+        tb_evict(cpu);
         mmap_unlock();
         /* Make the execution loop process the flush as soon as possible.  */
         cpu->exception_index = EXCP_INTERRUPT;
@@ -1427,6 +1619,10 @@ TranslationBlock *tb_gen_code(CPUState *cpu,
     tb->flags = flags;
     tb->cflags = cflags;
     tb->trace_vcpu_dstate = *cpu->trace_dstate;
+    tb->tier = tb_tier(pc, cflags);
+    tb->prefetched = false;
+    tb->exec_count = 0;
+    tb->lookup_epoch = qatomic_read(&tb_ctx.tb_evict_count);
     tcg_ctx->tb_cflags = cflags;
  tb_overflow:
 
@@ -1596,6 +1792,7 @@ TranslationBlock *tb_gen_code(CPUState *cpu,
     qatomic_set(&tcg_ctx->code_gen_ptr, (void *)
         ROUND_UP((uintptr_t)gen_code_buf + gen_code_size + search_size,
                  CODE_GEN_ALIGN));
+    perf_report_tb(tb);
 
     /* init jump list */
     qemu_spin_init(&tb->jmp_lock);
@@ -2070,6 +2267,8 @@ void dump_exec_info(GString *buf)
     struct tb_tree_stats tst = {};
     struct qht_stats hst;
     size_t nb_tbs, flush_full, flush_part, flush_elide;
+    uint64_t ras_hits = 0, ras_other = 0;
+    CPUState *cpu;
 
     tcg_tb_foreach(tb_tree_stats_iter, &tst);
     nb_tbs = tst.nb_tbs;
@@ -2108,9 +2307,20 @@ void dump_exec_info(GString *buf)
     g_string_append_printf(buf, "\nStatistics:\n");
     g_string_append_printf(buf, "TB flush count      %u\n",
                            qatomic_read(&tb_ctx.tb_flush_count));
+    g_string_append_printf(buf, "TB evict count      %u\n",
+                           qatomic_read(&tb_ctx.tb_evict_count));
     g_string_append_printf(buf, "TB invalidate count %u\n",
                            qatomic_read(&tb_ctx.tb_phys_invalidate_count));
 
+    CPU_FOREACH(cpu) {
+        ras_hits += cpu->tb_ras_hits;
+        ras_other += cpu->tb_ras_mispredicts + cpu->tb_ras_misses;
+    }
+    g_string_append_printf(buf, "return hits         %" PRIu64 " (%" PRIu64
+                           "%%)\n", ras_hits,
+                           ras_hits + ras_other ?
+                           ras_hits * 100 / (ras_hits + ras_other) : 0);
+
     tlb_flush_counts(&flush_full, &flush_part, &flush_elide);
     g_string_append_printf(buf, "TLB full flushes    %zu\n", flush_full);
     g_string_append_printf(buf, "TLB partial flushes %zu\n", flush_part);
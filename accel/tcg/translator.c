@@ -13,10 +13,15 @@
 #include "tcg/tcg-op.h"
 #include "exec/exec-all.h"
 #include "exec/gen-icount.h"
+#include "exec/helper-gen.h"
 #include "exec/log.h"
 #include "exec/translator.h"
 #include "exec/plugin-gen.h"
 #include "sysemu/replay.h"
+#include "tb-prefetch.h"
+#ifdef CONFIG_FEAR5
+#include "fear5/faultinjection.h"
+#endif
 
 /* Pairs with tcg_clear_temp_count.
    To be called by #TranslatorOps.{translate_insn,tb_stop} if
@@ -39,7 +44,187 @@ bool translator_use_goto_tb(DisasContextBase *db, target_ulong dest)
     }
 
     /* Check for the dest on the same page as the start of the TB.  */
-    return ((db->pc_first ^ dest) & TARGET_PAGE_MASK) == 0;
+    if (((db->pc_first ^ dest) & TARGET_PAGE_MASK) != 0) {
+        return false;
+    }
+
+    if (db->num_succ < ARRAY_SIZE(db->succ)) {
+        db->succ[db->num_succ++] = dest;
+    }
+    return true;
+}
+
+bool translator_sb_follow(DisasContextBase *db, target_ulong dest)
+{
+    /* Going forward only keeps the guest code of the TB one range */
+    return db->superblock && dest > db->pc_next &&
+           ((db->pc_first ^ dest) & TARGET_PAGE_MASK) == 0;
+}
+
+uint32_t translator_exec_count(DisasContextBase *db, CPUState *cpu,
+                               target_ulong pc)
+{
+    const TranslationBlock *tb = db->tb;
+    TranslationBlock *succ;
+
+    if (((db->pc_first ^ pc) & TARGET_PAGE_MASK) != 0) {
+        return 0;
+    }
+    succ = tb_htable_lookup(cpu, pc, tb->cs_base, tb->flags, tb_cflags(tb));
+    return succ ? qatomic_read(&succ->exec_count) : 0;
+}
+
+/* Offset of a CPUState field from env */
+#define CPU_ENV_OFFSET(field) \
+    (offsetof(ArchCPU, parent_obj.field) - offsetof(ArchCPU, env))
+
+/*
+ * The inline check of a prediction compares cs_base with the one of the
+ * current TB.  FEAR5 passes the fault key of the mutant in cs_base, and
+ * TBs without fault hooks (key 0) are shared by all mutants of a
+ * campaign, so the prediction is only valid without a campaign.
+ */
+static bool translator_use_ras(DisasContextBase *db)
+{
+#ifdef CONFIG_FEAR5
+    if (db->tb->cs_base != 0 || FEAR5_COUNT) {
+        return false;
+    }
+#endif
+    return true;
+}
+
+/* The part of *cpu->trace_dstate that tb_lookup() compares */
+#ifdef HOST_WORDS_BIGENDIAN
+#define TRACE_DSTATE_OFFSET \
+    (CPU_ENV_OFFSET(trace_dstate) + sizeof(unsigned long) - sizeof(uint32_t))
+#else
+#define TRACE_DSTATE_OFFSET CPU_ENV_OFFSET(trace_dstate)
+#endif
+
+/* Leave the address of the entry at @top in @ptr */
+static void gen_ras_entry(TCGv_ptr ptr, TCGv_i32 top)
+{
+    TCGv_i32 ofs = tcg_temp_new_i32();
+
+    tcg_gen_muli_i32(ofs, top, sizeof(CPUTBRasEntry));
+    tcg_gen_ext_i32_ptr(ptr, ofs);
+    tcg_gen_add_ptr(ptr, ptr, cpu_env);
+    tcg_temp_free_i32(ofs);
+}
+
+void translator_ras_push(DisasContextBase *db, target_ulong link)
+{
+    TCGv_i32 top;
+    TCGv_ptr ptr;
+
+    if (!translator_use_ras(db)) {
+        return;
+    }
+    top = tcg_temp_new_i32();
+    ptr = tcg_temp_new_ptr();
+    tcg_gen_ld_i32(top, cpu_env, CPU_ENV_OFFSET(tb_ras_top));
+    tcg_gen_addi_i32(top, top, 1);
+    tcg_gen_andi_i32(top, top, TB_RAS_SIZE - 1);
+    tcg_gen_st_i32(top, cpu_env, CPU_ENV_OFFSET(tb_ras_top));
+    gen_ras_entry(ptr, top);
+    tcg_gen_st_i64(tcg_constant_i64(link), ptr,
+                   CPU_ENV_OFFSET(tb_ras[0].ret_pc));
+    tcg_temp_free_ptr(ptr);
+    tcg_temp_free_i32(top);
+}
+
+void translator_ras_return(DisasContextBase *db, TCGv dest, uint32_t flags)
+{
+    const TranslationBlock *tb = db->tb;
+    TCGLabel *miss;
+    TCGv_i32 top, val, cur;
+    TCGv_i64 ret, addr64, hits;
+    TCGv_ptr ptr, pred;
+    TCGv addr;
+
+    if (!translator_use_ras(db) || (tb_cflags(tb) & CF_NO_GOTO_PTR)) {
+        tcg_gen_lookup_and_goto_ptr();
+        return;
+    }
+    plugin_gen_disable_mem_helpers();
+    miss = gen_new_label();
+
+    /* Pop the entry of this call depth */
+    top = tcg_temp_new_i32();
+    ptr = tcg_temp_new_ptr();
+    ret = tcg_temp_new_i64();
+    pred = tcg_temp_local_new_ptr();
+    tcg_gen_ld_i32(top, cpu_env, CPU_ENV_OFFSET(tb_ras_top));
+    gen_ras_entry(ptr, top);
+    tcg_gen_ld_i64(ret, ptr, CPU_ENV_OFFSET(tb_ras[0].ret_pc));
+    tcg_gen_ld_ptr(pred, ptr, CPU_ENV_OFFSET(tb_ras[0].tb));
+    tcg_gen_subi_i32(top, top, 1);
+    tcg_gen_andi_i32(top, top, TB_RAS_SIZE - 1);
+    tcg_gen_st_i32(top, cpu_env, CPU_ENV_OFFSET(tb_ras_top));
+    tcg_temp_free_i32(top);
+    tcg_temp_free_ptr(ptr);
+
+    /* The return must go to the address pushed by the call */
+    addr64 = tcg_temp_new_i64();
+    tcg_gen_extu_tl_i64(addr64, dest);
+    tcg_gen_brcond_i64(TCG_COND_NE, addr64, ret, miss);
+    tcg_temp_free_i64(addr64);
+    tcg_temp_free_i64(ret);
+
+    /* Validate the predicted TB as tb_lookup() would */
+    tcg_gen_brcondi_ptr(TCG_COND_EQ, pred, 0, miss);
+    addr = tcg_temp_new();
+    tcg_gen_ld_tl(addr, pred, offsetof(TranslationBlock, pc));
+    tcg_gen_brcond_tl(TCG_COND_NE, addr, dest, miss);
+    tcg_gen_ld_tl(addr, pred, offsetof(TranslationBlock, cs_base));
+    tcg_gen_brcondi_tl(TCG_COND_NE, addr, tb->cs_base, miss);
+    tcg_temp_free(addr);
+    val = tcg_temp_new_i32();
+    tcg_gen_ld_i32(val, pred, offsetof(TranslationBlock, flags));
+    tcg_gen_brcondi_i32(TCG_COND_NE, val, flags, miss);
+    tcg_gen_ld_i32(val, pred, offsetof(TranslationBlock, cflags));
+    tcg_gen_brcondi_i32(TCG_COND_NE, val, tb_cflags(tb), miss);
+    cur = tcg_temp_new_i32();
+    tcg_gen_ld_i32(val, pred, offsetof(TranslationBlock, trace_vcpu_dstate));
+    tcg_gen_ld_i32(cur, cpu_env, TRACE_DSTATE_OFFSET);
+    tcg_gen_brcond_i32(TCG_COND_NE, val, cur, miss);
+    tcg_temp_free_i32(cur);
+    tcg_temp_free_i32(val);
+
+    hits = tcg_temp_new_i64();
+    tcg_gen_ld_i64(hits, cpu_env, CPU_ENV_OFFSET(tb_ras_hits));
+    tcg_gen_addi_i64(hits, hits, 1);
+    tcg_gen_st_i64(hits, cpu_env, CPU_ENV_OFFSET(tb_ras_hits));
+    tcg_temp_free_i64(hits);
+    tcg_gen_ld_ptr(pred, pred, offsetof(TranslationBlock, tc.ptr));
+    tcg_gen_op1i(INDEX_op_goto_ptr, tcgv_ptr_arg(pred));
+
+    gen_set_label(miss);
+    gen_helper_lookup_tb_ptr_ret(pred, cpu_env);
+    tcg_gen_op1i(INDEX_op_goto_ptr, tcgv_ptr_arg(pred));
+    tcg_temp_free_ptr(pred);
+}
+
+/*
+ * Count the executions of @tb and promote it through helper_tb_hot() once
+ * it reaches tb_hot_threshold.
+ */
+static void gen_tb_count(const TranslationBlock *tb)
+{
+    TCGv_ptr counter = tcg_const_ptr(&tb->exec_count);
+    TCGv_i32 val = tcg_temp_new_i32();
+    TCGLabel *cold = gen_new_label();
+
+    tcg_gen_ld_i32(val, counter, 0);
+    tcg_gen_addi_i32(val, val, 1);
+    tcg_gen_st_i32(val, counter, 0);
+    tcg_gen_brcondi_i32(TCG_COND_NE, val, tb_hot_threshold, cold);
+    gen_helper_tb_hot(tcg_constant_ptr(tb));
+    gen_set_label(cold);
+
+    tcg_temp_free_i32(val);
+    tcg_temp_free_ptr(counter);
 }
 
 static inline void translator_page_protect(DisasContextBase *dcbase,
@@ -65,6 +250,8 @@ void translator_loop(const TranslatorOps *ops, DisasContextBase *db,
     db->num_insns = 0;
     db->max_insns = max_insns;
     db->singlestep_enabled = cflags & CF_SINGLE_STEP;
+    db->superblock = tb->tier == TB_TIER_SUPERBLOCK;
+    db->num_succ = 0;
     translator_page_protect(db, db->pc_next);
 
     ops->init_disas_context(db, cpu);
@@ -75,6 +262,9 @@ void translator_loop(const TranslatorOps *ops, DisasContextBase *db,
 
     /* Start translating.  */
     gen_tb_start(db->tb);
+    if (tb->tier == TB_TIER_COUNT) {
+        gen_tb_count(tb);
+    }
     ops->tb_start(db, cpu);
     tcg_debug_assert(db->is_jmp == DISAS_NEXT);  /* no early exit */
 
@@ -136,6 +326,10 @@ void translator_loop(const TranslatorOps *ops, DisasContextBase *db,
     tb->size = db->pc_next - db->pc_first;
     tb->icount = db->num_insns;
 
+    for (int i = 0; i < db->num_succ; i++) {
+        tb_prefetch_queue(cpu, tb, db->succ[i]);
+    }
+
 #ifdef DEBUG_DISAS
     if (qemu_loglevel_mask(CPU_LOG_TB_IN_ASM)
         && qemu_log_in_addr_range(db->pc_first)) {
@@ -0,0 +1,252 @@
+/*
+ * Copyright (c) 2022 Paderborn University, DE
+ *
+ * FEAR5 golden run profile - count instruction and memory accesses with
+ * stock TCG. The report uses the same format as the golden run
+ * statistics of -d goldenrun, so both can be compared directly. TB
+ * execution counts, which -d goldenrun does not report, can be written
+ * to a separate file.
+ *
+ * SPDX-License-Identifier: GPL-2.0-or-later
+ */
+#include <inttypes.h>
+#include <assert.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <stdio.h>
+#include <glib.h>
+
+#include <qemu-plugin.h>
+
+QEMU_PLUGIN_EXPORT int qemu_plugin_version = QEMU_PLUGIN_VERSION;
+
+static bool do_inline = true;
+static bool track_mem = true;
+static char *tb_file;
+
+/* Plugins need to take care of their own locking */
+static GMutex lock;
+static GHashTable *tbs;
+static GHashTable *insns;
+static GHashTable *mem[3];
+
+typedef struct {
+    uint64_t addr;
+    uint64_t count;
+} ExecCount;
+
+typedef struct {
+    uint64_t addr;
+    uint64_t r;
+    uint64_t w;
+} MemCount;
+
+static const char *mem_prefix[] = { "MEM_8", "MEM_16", "MEM_32" };
+
+#define SEPARATOR \
+    "--------------------------------------------------------------------------------\n"
+
+static gint cmp_addr(gconstpointer a, gconstpointer b)
+{
+    uint64_t ea = *(uint64_t *) a;
+    uint64_t eb = *(uint64_t *) b;
+    return ea < eb ? -1 : (ea > eb);
+}
+
+/*
+ * Counters are looked up by guest address, so a TB translated again
+ * (e.g. after a flush) keeps counting into the same entry.
+ */
+static ExecCount *get_exec_count(GHashTable *ht, uint64_t addr)
+{
+    ExecCount *cnt;
+
+    g_mutex_lock(&lock);
+    cnt = g_hash_table_lookup(ht, GUINT_TO_POINTER(addr));
+    if (!cnt) {
+        cnt = g_new0(ExecCount, 1);
+        cnt->addr = addr;
+        g_hash_table_insert(ht, GUINT_TO_POINTER(addr), cnt);
+    }
+    g_mutex_unlock(&lock);
+    return cnt;
+}
+
+static void report_exec(GString *report, GHashTable *ht, const char *prefix)
+{
+    GList *counts = g_list_sort(g_hash_table_get_values(ht), cmp_addr);
+
+    for (GList *it = counts; it; it = it->next) {
+        ExecCount *rec = (ExecCount *) it->data;
+        g_string_append_printf(report, "%s[%08"PRIx64"]:%"PRIu64"\n",
+                               prefix, rec->addr, rec->count);
+    }
+    g_list_free(counts);
+}
+
+static void write_tb_file(void)
+{
+    g_autoptr(GString) report = g_string_new("TB executions:\n");
+    g_autoptr(GError) err = NULL;
+
+    report_exec(report, tbs, "TB");
+    if (!g_file_set_contents(tb_file, report->str, report->len, &err)) {
+        fprintf(stderr, "fear5prof: %s\n", err->message);
+    }
+}
+
+static void plugin_exit(qemu_plugin_id_t id, void *p)
+{
+    g_autoptr(GString) report = g_string_new("");
+
+    g_mutex_lock(&lock);
+
+    if (tb_file) {
+        write_tb_file();
+    }
+
+    g_string_append(report, "\nINSTRUCTION executions:\n" SEPARATOR);
+    report_exec(report, insns, "EXE");
+
+    if (track_mem) {
+        g_string_append(report,
+                        "\nMemory executions <#reads, #writes, #total>:\n"
+                        SEPARATOR);
+        for (int i = 0; i < 3; i++) {
+            GList *counts = g_list_sort(g_hash_table_get_values(mem[i]),
+                                        cmp_addr);
+            for (GList *it = counts; it; it = it->next) {
+                MemCount *rec = (MemCount *) it->data;
+                g_string_append_printf(report,
+                                       "%s[%08"PRIx64"]:%"PRIu64",%"PRIu64
+                                       ",%"PRIu64"\n",
+                                       mem_prefix[i], rec->addr, rec->r,
+                                       rec->w, rec->r + rec->w);
+            }
+            g_list_free(counts);
+        }
+        g_string_append(report, SEPARATOR);
+    }
+
+    g_mutex_unlock(&lock);
+
+    qemu_plugin_outs(report->str);
+}
+
+static void plugin_init(void)
+{
+    tbs = g_hash_table_new(NULL, g_direct_equal);
+    insns = g_hash_table_new(NULL, g_direct_equal);
+    for (int i = 0; i < 3; i++) {
+        mem[i] = g_hash_table_new(NULL, g_direct_equal);
+    }
+}
+
+static void vcpu_exec(unsigned int cpu_index, void *udata)
+{
+    ExecCount *cnt = (ExecCount *) udata;
+
+    g_mutex_lock(&lock);
+    cnt->count++;
+    g_mutex_unlock(&lock);
+}
+
+static void vcpu_mem(unsigned int cpu_index, qemu_plugin_meminfo_t meminfo,
+                     uint64_t vaddr, void *udata)
+{
+    unsigned int shift = qemu_plugin_mem_size_shift(meminfo);
+    MemCount *cnt;
+
+    /* FEAR5 only keeps statistics for 8, 16 and 32 bit accesses */
+    if (shift > 2) {
+        return;
+    }
+
+    g_mutex_lock(&lock);
+    cnt = g_hash_table_lookup(mem[shift], GUINT_TO_POINTER(vaddr));
+    if (!cnt) {
+        cnt = g_new0(MemCount, 1);
+        cnt->addr = vaddr;
+        g_hash_table_insert(mem[shift], GUINT_TO_POINTER(vaddr), cnt);
+    }
+    if (qemu_plugin_mem_is_store(meminfo)) {
+        cnt->w++;
+    } else {
+        cnt->r++;
+    }
+    g_mutex_unlock(&lock);
+}
+
+/*
+ * When do_inline we ask the plugin to increment the counters for us.
+ * Otherwise a helper is inserted which calls the vcpu_exec callback.
+ */
+static void vcpu_tb_trans(qemu_plugin_id_t id, struct qemu_plugin_tb *tb)
+{
+    size_t n = qemu_plugin_tb_n_insns(tb);
+    ExecCount *cnt;
+
+    if (tb_file) {
+        cnt = get_exec_count(tbs, qemu_plugin_tb_vaddr(tb));
+        if (do_inline) {
+            qemu_plugin_register_vcpu_tb_exec_inline(
+                tb, QEMU_PLUGIN_INLINE_ADD_U64, &cnt->count, 1);
+        } else {
+            qemu_plugin_register_vcpu_tb_exec_cb(tb, vcpu_exec,
+                                                 QEMU_PLUGIN_CB_NO_REGS, cnt);
+        }
+    }
+
+    for (size_t i = 0; i < n; i++) {
+        struct qemu_plugin_insn *insn = qemu_plugin_tb_get_insn(tb, i);
+
+        cnt = get_exec_count(insns, qemu_plugin_insn_vaddr(insn));
+        if (do_inline) {
+            qemu_plugin_register_vcpu_insn_exec_inline(
+                insn, QEMU_PLUGIN_INLINE_ADD_U64, &cnt->count, 1);
+        } else {
+            qemu_plugin_register_vcpu_insn_exec_cb(insn, vcpu_exec,
+                                                   QEMU_PLUGIN_CB_NO_REGS,
+                                                   cnt);
+        }
+
+        if (track_mem) {
+            qemu_plugin_register_vcpu_mem_cb(insn, vcpu_mem,
+                                             QEMU_PLUGIN_CB_NO_REGS,
+                                             QEMU_PLUGIN_MEM_RW, NULL);
+        }
+    }
+}
+
+QEMU_PLUGIN_EXPORT
+int qemu_plugin_install(qemu_plugin_id_t id, const qemu_info_t *info,
+                        int argc, char **argv)
+{
+    for (int i = 0; i < argc; i++) {
+        char *opt = argv[i];
+        g_autofree char **tokens = g_strsplit(opt, "=", 2);
+        if (g_strcmp0(tokens[0], "inline") == 0) {
+            if (!qemu_plugin_bool_parse(tokens[0], tokens[1], &do_inline)) {
+                fprintf(stderr, "boolean argument parsing failed: %s\n", opt);
+                return -1;
+            }
+        } else if (g_strcmp0(tokens[0], "mem") == 0) {
+            if (!qemu_plugin_bool_parse(tokens[0], tokens[1], &track_mem)) {
+                fprintf(stderr, "boolean argument parsing failed: %s\n", opt);
+                return -1;
+            }
+        } else if (g_strcmp0(tokens[0], "tbs") == 0 && tokens[1]) {
+            tb_file = g_strdup(tokens[1]);
+        } else {
+            fprintf(stderr, "option parsing failed: %s\n", opt);
+            return -1;
+        }
+    }
+
+    plugin_init();
+
+    qemu_plugin_register_vcpu_tb_trans_cb(id, vcpu_tb_trans);
+    qemu_plugin_register_atexit_cb(id, plugin_exit, NULL);
+    return 0;
+}
@@ -1,7 +1,14 @@
 #include "fear5/faultinjection.h"
 #include "fear5/logger.h"
 #include "fear5/parser.h"
+#include "fear5/stats.h"
+#include "fear5/taint.h"
+#include "fear5/trace.h"
+#ifdef CONFIG_USER_ONLY
+#include "fear5/user.h"
+#else
 #include "sysemu/runstate.h"
+#endif
 #include <time.h>
 
 Fear5State *f5;
@@ -46,52 +53,59 @@ static inline void log_mem_stats(GHashTable *ht, const char *prefix)
     }
 }
 
-void qemu_fi_exit(int i, const char *t) {
+void fear5_log_golden_stats(void)
+{
+    /* Output GPR Accesses (R/W/Total) */
+    qemu_log("\nGPR executions <#reads, #writes, #total>:\n");
+    qemu_log("--------------------------------------------------------------------------------\n");
+    for (int i = 1; i < 32; i++) {
+        qemu_log("GPR[%d]:%" PRIu64 ",%" PRIu64 ",%" PRIu64 "\n", i, f5->gpr[i].r, f5->gpr[i].w, f5->gpr[i].r + f5->gpr[i].w);
+    }
 
-    /* Compact golden run statistics... */
-    if (qemu_loglevel_mask(FEAR5_LOG_GOLDENRUN)) {
-        /* Output GPR Accesses (R/W/Total) */
-        qemu_log("\nGPR executions <#reads, #writes, #total>:\n");
-        qemu_log("--------------------------------------------------------------------------------\n");
-        for (int i = 1; i < 32; i++) {
-            qemu_log("GPR[%d]:%" PRIu64 ",%" PRIu64 ",%" PRIu64 "\n", i, f5->gpr[i].r, f5->gpr[i].w, f5->gpr[i].r + f5->gpr[i].w);
+    /* Output CSR Accesses (R/W/Total) */
+    qemu_log("\nCSR executions <#reads, #writes, #total>:\n");
+    qemu_log("--------------------------------------------------------------------------------\n");
+    for (int i = 0; i < 4096; i++) {
+        /* Skip reporting about any CSR without accesses */
+        uint64_t a = f5->csr[i].r + f5->csr[i].w;
+        if (a) {
+            qemu_log("CSR[%d]:%" PRIu64 ",%" PRIu64 ",%" PRIu64 "\n", i, f5->csr[i].r, f5->csr[i].w, a);
         }
+    }
 
-        /* Output CSR Accesses (R/W/Total) */
-        qemu_log("\nCSR executions <#reads, #writes, #total>:\n");
-        qemu_log("--------------------------------------------------------------------------------\n");
-        for (int i = 0; i < 4096; i++) {
-            /* Skip reporting about any CSR without accesses */
-            uint64_t a = f5->csr[i].r + f5->csr[i].w;
-            if (a) {
-                qemu_log("CSR[%d]:%" PRIu64 ",%" PRIu64 ",%" PRIu64 "\n", i, f5->csr[i].r, f5->csr[i].w, a);
-            }
-        }
+    /* Calculate and output PC exec stats... */
+    GHashTable *pc_exe = g_hash_table_new_full(g_direct_hash, g_direct_equal, NULL, g_free);
+    g_list_foreach(g_hash_table_get_values(f5->tb), get_pc_exe, pc_exe);
 
-        /* Calculate and output PC exec stats... */
-        GHashTable *pc_exe = g_hash_table_new_full(g_direct_hash, g_direct_equal, NULL, g_free);
-        g_list_foreach(g_hash_table_get_values(f5->tb), get_pc_exe, pc_exe);
-
-        /* Output PC_EXEC_SUMMARY */
-        qemu_log("\nINSTRUCTION executions:\n");
-        qemu_log("--------------------------------------------------------------------------------\n");
-        GList *k = g_list_sort(g_hash_table_get_keys(pc_exe), compare);
-        while(k) {
-            uint64_t *counter = g_hash_table_lookup(pc_exe, k->data);
-            qemu_log("EXE[" TARGET_FMT_lx "]:%" PRIu64 "\n", GPOINTER_TO_UINT(k->data), *counter);
-            k = k->next;
-        }
-        g_hash_table_destroy(pc_exe);
+    /* Output PC_EXEC_SUMMARY */
+    qemu_log("\nINSTRUCTION executions:\n");
+    qemu_log("--------------------------------------------------------------------------------\n");
+    GList *k = g_list_sort(g_hash_table_get_keys(pc_exe), compare);
+    while(k) {
+        uint64_t *counter = g_hash_table_lookup(pc_exe, k->data);
+        qemu_log("EXE[" TARGET_FMT_lx "]:%" PRIu64 "\n", GPOINTER_TO_UINT(k->data), *counter);
+        k = k->next;
+    }
+    g_hash_table_destroy(pc_exe);
 
-        /* Output MEM Accesses (R/W/Total) */
-        qemu_log("\nMemory executions <#reads, #writes, #total>:\n");
-        qemu_log("--------------------------------------------------------------------------------\n");
-        log_mem_stats(f5->mem8,  "MEM_8");
-        log_mem_stats(f5->mem16, "MEM_16");
-        log_mem_stats(f5->mem32, "MEM_32");
-        qemu_log("--------------------------------------------------------------------------------\n");
+    /* Output MEM Accesses (R/W/Total) */
+    qemu_log("\nMemory executions <#reads, #writes, #total>:\n");
+    qemu_log("--------------------------------------------------------------------------------\n");
+    log_mem_stats(f5->mem8,  "MEM_8");
+    log_mem_stats(f5->mem16, "MEM_16");
+    log_mem_stats(f5->mem32, "MEM_32");
+    qemu_log("--------------------------------------------------------------------------------\n");
+}
+
+void qemu_fi_exit(int i, const char *t) {
+
+    /* Compact golden run statistics... */
+    if (qemu_loglevel_mask(FEAR5_LOG_GOLDENRUN)) {
+        fear5_log_golden_stats();
     }
 
+    fear5_exec_trace_end();
+
     if (t != NULL) {
         printf("%s\n", t);
     }
@@ -111,8 +125,15 @@ void fear5_kill_mutant(uint32_t code) {
     }
 
     f5->next_code = code;
+    fear5_stats_mutant_killed();
+    fear5_taint_end();
 
+#ifdef CONFIG_USER_ONLY
+    /* Every run is a child process of the fork server, see fear5/user.c */
+    fear5_user_kill(code);
+#else
     qemu_system_reset_request(SHUTDOWN_CAUSE_GUEST_RESET);
+#endif
 
 }
 
@@ -133,6 +154,233 @@ MemStimulator* fear5_get_stimulator(uint64_t address)
     return (MemStimulator *) g_hash_table_lookup(setup->stimulators, GINT_TO_POINTER(address));
 }
 
+static bool fear5_table_overlaps(GHashTable *table, uint64_t address, uint64_t size)
+{
+    GHashTableIter iter;
+    gpointer key;
+
+    if (!table) {
+        return false;
+    }
+    g_hash_table_iter_init(&iter, table);
+    while (g_hash_table_iter_next(&iter, &key, NULL)) {
+        /* Keys are GINT_TO_POINTER(address), like the lookups above */
+        if ((uint32_t) GPOINTER_TO_INT(key) - (uint32_t) address < size) {
+            return true;
+        }
+    }
+    return false;
+}
+
+/* For bulk accesses, which cannot look up every address on its own */
+bool fear5_io_overlaps(uint64_t address, uint64_t size)
+{
+    return setup && (fear5_table_overlaps(setup->monitors, address, size) ||
+                     fear5_table_overlaps(setup->stimulators, address, size));
+}
+
+static inline bool fear5_is_dmem_kind(int kind)
+{
+    switch (kind) {
+        case DMEM_PERMANENT:
+        case DMEM_TRANSIENT:
+        case DMEM_STUCK_AT_ZERO:
+        case DMEM_STUCK_AT_ONE:
+            return true;
+    }
+    return false;
+}
+
+bool fear5_dmem_active(void)
+{
+    Mutant *m = FEAR5_CURRENT;
+    return f5->phase == MUTANT && m && fear5_is_dmem_kind(m->kind);
+}
+
+bool fear5_dmem_page_matches(target_ulong vaddr_page)
+{
+    /* Only the page holding the faulty memory cell leaves the TLB fast path */
+    return fear5_dmem_active() &&
+           (FEAR5_CURRENT->addr_reg_mem & TARGET_PAGE_MASK) == vaddr_page;
+}
+
+uint64_t fear5_mutate_memop(target_ulong addr, uint64_t val, MemOp op)
+{
+    Mutant *m = FEAR5_CURRENT;
+    unsigned s = memop_size(op);
+
+    if (!m || m->addr_reg_mem < addr || m->addr_reg_mem >= addr + s) {
+        return val;
+    }
+
+    /* Move the bit error to the faulty byte within this access */
+    uint64_t e = (m->biterror << ((m->addr_reg_mem - addr) * 8)) &
+                 MAKE_64BIT_MASK(0, s * 8);
+
+    switch (m->kind) {
+        case DMEM_TRANSIENT:
+            /* Flip the value transferred by the n-th access to the cell */
+            if (++f5->dmem_access != m->nr_access) {
+                return val;
+            }
+            fear5_taint_mem(addr);
+            return val ^ e;
+        case DMEM_PERMANENT:
+            fear5_taint_mem(addr);
+            return val ^ e;
+        case DMEM_STUCK_AT_ZERO:
+            fear5_taint_mem(addr);
+            return val & ~e;
+        case DMEM_STUCK_AT_ONE:
+            fear5_taint_mem(addr);
+            return val | e;
+    }
+    return val;
+}
+
+/*
+ * Translated code only depends on the current mutant if it contains fault
+ * hooks: GPR and IFR faults, DMEM faults in linux-user mode, and IMEM
+ * faults in linux-user mode or with -mutant-taint.  Otherwise, IMEM faults
+ * are written to guest memory (see fear5_ram_patch_imem()).  Each distinct
+ * set of hooks gets a small key, which is handed to the TB lookup as
+ * cs_base.  Key 0 is reserved for translations without any hooks, which
+ * are shared by all mutants.
+ */
+static GHashTable *tb_keys;
+
+void fear5_update_tb_key(void)
+{
+    Mutant *m = FEAR5_CURRENT;
+    gpointer key;
+    char *sig;
+
+    if (!m) {
+        f5->tb_key = 0;
+        return;
+    }
+
+    switch (m->kind) {
+        case GPR_TRANSIENT:
+            /* The bit error is applied at runtime by helper_f5_mutate_gpr */
+            sig = g_strdup_printf("%d:%" PRIu64, m->kind, m->addr_reg_mem);
+            break;
+        case GPR_PERMANENT:
+        case GPR_STUCK_AT_ZERO:
+        case GPR_STUCK_AT_ONE:
+            sig = g_strdup_printf("%d:%" PRIu64 ":%" PRIx64, m->kind, m->addr_reg_mem, m->biterror);
+            break;
+        case IMEM_PERMANENT:
+        case IMEM_STUCK_AT_ZERO:
+        case IMEM_STUCK_AT_ONE:
+#ifndef CONFIG_USER_ONLY
+            /* Patched IMEM faults only end up in translated code as taint */
+            if (!fear5_taint_enabled()) {
+                f5->tb_key = 0;
+                return;
+            }
+#endif
+            sig = g_strdup_printf("%d:%" PRIu64 ":%" PRIx64, m->kind, m->addr_reg_mem, m->biterror);
+            break;
+        case IFR_PERMANENT:
+        case IFR_STUCK_AT_ZERO:
+        case IFR_STUCK_AT_ONE:
+            sig = g_strdup_printf("%d:%" PRIx64, m->kind, m->biterror);
+            break;
+#ifdef CONFIG_USER_ONLY
+        case DMEM_PERMANENT:
+        case DMEM_TRANSIENT:
+        case DMEM_STUCK_AT_ZERO:
+        case DMEM_STUCK_AT_ONE:
+            /* The hooks of all DMEM faults read the mutant at runtime */
+            sig = g_strdup("dmem");
+            break;
+#endif
+        default:
+            /* CSR, DMEM (and patched IMEM) faults never end up in translated code */
+            f5->tb_key = 0;
+            return;
+    }
+
+    if (tb_keys == NULL) {
+        tb_keys = g_hash_table_new_full(g_str_hash, g_str_equal, g_free, NULL);
+    }
+    key = g_hash_table_lookup(tb_keys, sig);
+    if (key == NULL) {
+        key = GUINT_TO_POINTER(g_hash_table_size(tb_keys) + 1);
+        g_hash_table_insert(tb_keys, sig, key);
+    } else {
+        g_free(sig);
+    }
+    f5->tb_key = GPOINTER_TO_UINT(key);
+}
+
+bool fear5_tb_affected(target_ulong pc, target_ulong size, uint32_t gpr_mask)
+{
+    Mutant *m = FEAR5_CURRENT;
+
+    /* Golden run statistics are recorded by every TB */
+    if (qemu_loglevel_mask(FEAR5_LOG_GOLDENRUN)) {
+        return true;
+    }
+    if (!m) {
+        return false;
+    }
+
+    switch (m->kind) {
+        case GPR_PERMANENT:
+        case GPR_TRANSIENT:
+        case GPR_STUCK_AT_ZERO:
+        case GPR_STUCK_AT_ONE:
+            return m->addr_reg_mem < 32 && (gpr_mask & (1u << m->addr_reg_mem));
+        case IMEM_PERMANENT:
+        case IMEM_STUCK_AT_ZERO:
+        case IMEM_STUCK_AT_ONE:
+#ifndef CONFIG_USER_ONLY
+            // The fault is in guest memory, only taint tracking marks the insn
+            if (!fear5_taint_enabled()) {
+                return false;
+            }
+#endif
+            return m->addr_reg_mem >= pc && m->addr_reg_mem < pc + size;
+#ifdef CONFIG_USER_ONLY
+        case DMEM_PERMANENT:
+        case DMEM_TRANSIENT:
+        case DMEM_STUCK_AT_ZERO:
+        case DMEM_STUCK_AT_ONE:
+            // Any load or store may hit the cell, shared TBs have no hooks
+            return true;
+#endif
+        case IFR_PERMANENT:
+        case IFR_STUCK_AT_ZERO:
+        case IFR_STUCK_AT_ONE:
+            return true;
+    }
+    return false;
+}
+
+bool fear5_insn_fault_active(void)
+{
+    Mutant *m = FEAR5_CURRENT;
+
+    if (!m) {
+        return false;
+    }
+
+    switch (m->kind) {
+#ifdef CONFIG_USER_ONLY
+        case IMEM_PERMANENT:
+        case IMEM_STUCK_AT_ZERO:
+        case IMEM_STUCK_AT_ONE:
+#endif
+        case IFR_PERMANENT:
+        case IFR_STUCK_AT_ZERO:
+        case IFR_STUCK_AT_ONE:
+            return true;
+    }
+    return false;
+}
+
 void fear5_printtime(const char* prefix)
 {
     struct timespec time;
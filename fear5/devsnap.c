@@ -0,0 +1,149 @@
+/*
+ * FEAR5 fast device reset
+ *
+ * Copyright (c) 2022 Paderborn University, DE
+ *
+ * SPDX-License-Identifier: GPL-2.0-or-later
+ */
+
+#include "fear5/faultinjection.h"
+#include "fear5/devsnap.h"
+#include "hw/boards.h"
+#include "hw/core/cpu.h"
+#include "hw/qdev-core.h"
+#include "hw/resettable.h"
+#include "hw/sysbus.h"
+#include "sysemu/reset.h"
+
+typedef struct Fear5DevSnapshot {
+    DeviceState *dev;
+    void *state;
+    size_t size;
+    void *image;
+    Fear5DevRestoreFn restore;
+} Fear5DevSnapshot;
+
+static GArray *devices = NULL;
+static bool enabled = true;
+static bool captured = false;
+static bool usable = false;
+
+void fear5_devsnap_register(DeviceState *dev, void *state, size_t size,
+                            Fear5DevRestoreFn restore)
+{
+    Fear5DevSnapshot d = {
+        .dev = dev,
+        .state = state,
+        .size = size,
+        .restore = restore,
+    };
+
+    if (devices == NULL) {
+        devices = g_array_new(FALSE, TRUE, sizeof(Fear5DevSnapshot));
+    }
+    g_array_append_val(devices, d);
+}
+
+static bool registered(DeviceState *dev)
+{
+    for (guint i = 0; devices && i < devices->len; i++) {
+        if (g_array_index(devices, Fear5DevSnapshot, i).dev == dev) {
+            return true;
+        }
+    }
+    return false;
+}
+
+static bool has_reset(Object *obj)
+{
+    ResettableClass *rc = RESETTABLE_GET_CLASS(obj);
+
+    return rc->phases.enter || rc->phases.hold || rc->phases.exit ||
+           (rc->get_transitional_function &&
+            rc->get_transitional_function(obj));
+}
+
+/*
+ * Every device, on a bus or not, whose state is migrated or reset has to
+ * be registered.  CPUs are reset by their reset handlers as usual.
+ */
+static int check_device(Object *obj, void *opaque)
+{
+    DeviceState *dev = (DeviceState *) object_dynamic_cast(obj, TYPE_DEVICE);
+    bool *ok = opaque;
+
+    if (!dev || !dev->realized || object_dynamic_cast(obj, TYPE_CPU)) {
+        return 0;
+    }
+    if ((DEVICE_GET_CLASS(dev)->vmsd || has_reset(obj)) && !registered(dev)) {
+        fprintf(stderr, "INFO: '%s' has no fast reset, using full resets.\n",
+                object_get_typename(obj));
+        *ok = false;
+    }
+    return 0;
+}
+
+void fear5_devsnap_capture(void)
+{
+    MachineClass *mc = MACHINE_GET_CLASS(current_machine);
+    bool ok = true;
+
+    if (captured) {
+        return;
+    }
+    captured = true;
+
+    /* The fast reset cannot tell what a machine reset hook would do */
+    if (mc->reset) {
+        fprintf(stderr, "INFO: '%s' has its own reset, using full resets.\n",
+                mc->name);
+        return;
+    }
+    object_child_foreach_recursive(object_get_root(), check_device, &ok);
+    if (!ok || !devices) {
+        return;
+    }
+
+    for (guint i = 0; i < devices->len; i++) {
+        Fear5DevSnapshot *d = &g_array_index(devices, Fear5DevSnapshot, i);
+        if (d->size) {
+            d->image = g_memdup(d->state, d->size);
+        }
+    }
+    usable = true;
+}
+
+void fear5_fast_reset_enable(bool on)
+{
+    enabled = on;
+}
+
+bool fear5_fast_reset(void)
+{
+    if (!enabled || !usable || !FEAR5_COUNT) {
+        return false;
+    }
+
+    for (guint i = 0; i < devices->len; i++) {
+        Fear5DevSnapshot *d = &g_array_index(devices, Fear5DevSnapshot, i);
+        if (d->size) {
+            memcpy(d->state, d->image, d->size);
+        }
+    }
+    /*
+     * All other reset handlers still run: rom_reset() restores the RAM
+     * snapshot (see fear5/ramsnap.c), the CPUs are reset by theirs.  Only
+     * the qdev tree is not walked, fear5_devsnap_capture() checked it.
+     */
+    qemu_devices_reset_except(resettable_cold_reset_fn, sysbus_get_default());
+
+    // Registration order is realize order, so the terminator (created with
+    // -device) selects the next mutant last
+    for (guint i = 0; i < devices->len; i++) {
+        Fear5DevSnapshot *d = &g_array_index(devices, Fear5DevSnapshot, i);
+        if (d->restore) {
+            d->restore(d->dev);
+        }
+    }
+    return true;
+}
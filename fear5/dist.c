@@ -0,0 +1,409 @@
+/*
+ * Distributed FEAR5 campaigns
+ *
+ * Copyright (c) 2022 Paderborn University, DE
+ *
+ * SPDX-License-Identifier: GPL-2.0-or-later
+ */
+
+#include "fear5/faultinjection.h"
+#include "fear5/dist.h"
+#include "fear5/logger.h"
+#include "fear5/parser.h"
+#include "fear5/stats.h"
+#include "qapi/error.h"
+#include "qemu/bitmap.h"
+#include "qemu/bswap.h"
+#include "qemu/sockets.h"
+#include <poll.h>
+
+/*
+ * All sockets are non-blocking.  Messages may arrive in pieces, the bytes
+ * of an incomplete one are kept here until the rest is there.
+ */
+typedef struct Fear5DistBuf {
+    size_t len;
+    Fear5DistMsg msg;
+} Fear5DistBuf;
+
+typedef struct Fear5DistWorker {
+    int fd;
+    Fear5DistBuf in;
+    bool hello;
+    bool waiting;           // sent a REQUEST that is not answered yet
+    uint32_t next;          // next index of the current range without result
+    uint32_t last;
+} Fear5DistWorker;
+
+static char *coordinator_address = NULL;
+static int worker_fd = -1;
+static Fear5DistBuf worker_in;
+static uint32_t worker_next = 0;
+static uint32_t worker_last = 0;
+
+/* Coordinator state */
+static GArray *pending = NULL;      // ranges not handed out yet, pairs of first/last
+static GPtrArray *workers = NULL;
+static unsigned long *reported = NULL;
+static uint32_t completed = 0;
+static uint64_t golden_time_max = 0;
+static bool golden_logged = false;
+
+static bool msg_write(int fd, Fear5DistMsg *m)
+{
+    Fear5DistMsg be = {
+        .type = cpu_to_be32(m->type),
+        .first = cpu_to_be32(m->first),
+        .last = cpu_to_be32(m->last),
+        .code = cpu_to_be32(m->code),
+        .time = cpu_to_be64(m->time),
+        .time_max = cpu_to_be64(m->time_max),
+    };
+    size_t n = 0;
+
+    // MSG_NOSIGNAL: a lost peer must not kill us (or a linux-user guest)
+    while (n < sizeof(be)) {
+        ssize_t r = send(fd, (char *) &be + n, sizeof(be) - n, MSG_NOSIGNAL);
+        if (r < 0 && (errno == EAGAIN || errno == EWOULDBLOCK)) {
+            // Messages are small and rare, the peer's buffer is full only
+            // if it stopped reading for good
+            struct pollfd pfd = { .fd = fd, .events = POLLOUT };
+            if (poll(&pfd, 1, -1) < 0 && errno != EINTR) {
+                return false;
+            }
+            continue;
+        }
+        if (r < 0 && errno == EINTR) {
+            continue;
+        }
+        if (r <= 0) {
+            return false;
+        }
+        n += r;
+    }
+    return true;
+}
+
+/*
+ * Read what is there of the next message into @b without blocking.
+ * Returns 1 and fills in @m once it is complete, 0 if more bytes are
+ * needed, and -1 if the connection is closed or broken.
+ */
+static int msg_recv(int fd, Fear5DistBuf *b, Fear5DistMsg *m)
+{
+    Fear5DistMsg be;
+
+    while (b->len < sizeof(b->msg)) {
+        ssize_t r = read(fd, (char *) &b->msg + b->len, sizeof(b->msg) - b->len);
+        if (r < 0 && errno == EINTR) {
+            continue;
+        }
+        if (r < 0 && (errno == EAGAIN || errno == EWOULDBLOCK)) {
+            return 0;
+        }
+        if (r <= 0) {
+            return -1;
+        }
+        b->len += r;
+    }
+    be = b->msg;
+    b->len = 0;
+
+    m->type = be32_to_cpu(be.type);
+    m->first = be32_to_cpu(be.first);
+    m->last = be32_to_cpu(be.last);
+    m->code = be32_to_cpu(be.code);
+    m->time = be64_to_cpu(be.time);
+    m->time_max = be64_to_cpu(be.time_max);
+    return 1;
+}
+
+/*
+ * Worker side
+ */
+
+void fear5_dist_worker(const char *address)
+{
+    Error *err = NULL;
+    SocketAddress *addr = socket_parse(address, &err);
+
+    if (addr) {
+        worker_fd = socket_connect(addr, &err);
+        qapi_free_SocketAddress(addr);
+    }
+    if (worker_fd < 0) {
+        error_reportf_err(err, "cannot connect to coordinator '%s': ", address);
+        exit(1);
+    }
+    qemu_set_nonblock(worker_fd);
+}
+
+/* Wait for the next message from the coordinator */
+static bool worker_recv(Fear5DistMsg *m)
+{
+    struct pollfd pfd = { .fd = worker_fd, .events = POLLIN };
+    int r;
+
+    while ((r = msg_recv(worker_fd, &worker_in, m)) == 0) {
+        if (poll(&pfd, 1, -1) < 0 && errno != EINTR) {
+            return false;
+        }
+    }
+    return r > 0;
+}
+
+bool fear5_dist_worker_enabled(void)
+{
+    return worker_fd >= 0;
+}
+
+void fear5_dist_goldenrun(uint64_t time, uint64_t time_max)
+{
+    Fear5DistMsg m = {
+        .type = F5_DIST_HELLO,
+        .first = FEAR5_COUNT,
+        .time = time,
+        .time_max = time_max,
+    };
+
+    if (worker_fd >= 0 && !msg_write(worker_fd, &m)) {
+        fprintf(stderr, "ERROR: lost connection to coordinator!\n");
+        exit(1);
+    }
+}
+
+void fear5_dist_result(uint64_t time, uint32_t code)
+{
+    Fear5DistMsg m = {
+        .type = F5_DIST_RESULT,
+        .first = FEAR5_INDEX,
+        .code = code,
+        .time = time,
+    };
+
+    if (worker_fd >= 0 && !msg_write(worker_fd, &m)) {
+        fprintf(stderr, "ERROR: lost connection to coordinator!\n");
+        exit(1);
+    }
+}
+
+int fear5_dist_next(void)
+{
+    Fear5DistMsg m = { .type = F5_DIST_REQUEST };
+
+    if (worker_next < worker_last) {
+        return worker_next++;
+    }
+
+    // Range used up, ask for the next one.  A closed connection means the
+    // coordinator has all results already.
+    if (!msg_write(worker_fd, &m) || !worker_recv(&m) ||
+        m.type != F5_DIST_RANGE || m.first >= m.last || m.last > FEAR5_COUNT) {
+        return -1;
+    }
+    worker_next = m.first;
+    worker_last = m.last;
+    return worker_next++;
+}
+
+/*
+ * Coordinator side
+ */
+
+void fear5_dist_set_coordinator(const char *address)
+{
+    g_free(coordinator_address);
+    coordinator_address = g_strdup(address);
+}
+
+bool fear5_dist_coordinator_enabled(void)
+{
+    return coordinator_address != NULL;
+}
+
+static void pending_push(uint32_t first, uint32_t last, bool front)
+{
+    uint32_t r[2] = { first, last };
+
+    if (front) {
+        g_array_prepend_vals(pending, r, 2);
+    } else {
+        g_array_append_vals(pending, r, 2);
+    }
+}
+
+static bool serve_range(Fear5DistWorker *w)
+{
+    Fear5DistMsg m = { .type = F5_DIST_RANGE };
+
+    if (pending->len == 0) {
+        return false;
+    }
+
+    m.first = g_array_index(pending, uint32_t, 0);
+    m.last = MIN(g_array_index(pending, uint32_t, 1), m.first + F5_DIST_CHUNK);
+    if (m.last == g_array_index(pending, uint32_t, 1)) {
+        g_array_remove_range(pending, 0, 2);
+    } else {
+        g_array_index(pending, uint32_t, 0) = m.last;
+    }
+
+    // A failed write shows up as a lost worker on the next poll, which
+    // re-queues the range again
+    w->next = m.first;
+    w->last = m.last;
+    w->waiting = false;
+    msg_write(w->fd, &m);
+    return true;
+}
+
+static void drop_worker(Fear5DistWorker *w)
+{
+    // Hand out whatever this worker did not report yet again...
+    if (w->next < w->last) {
+        fprintf(stderr, "INFO: worker lost, re-queuing mutants %u..%u\n", w->next, w->last - 1);
+        pending_push(w->next, w->last, true);
+    }
+    close(w->fd);
+    g_ptr_array_remove(workers, w);
+    g_free(w);
+}
+
+static bool handle_msg(Fear5DistWorker *w, Fear5DistMsg *m)
+{
+    switch (m->type) {
+        case F5_DIST_HELLO:
+            if (m->first != FEAR5_COUNT) {
+                fprintf(stderr, "WARNING: worker has %u mutants instead of %d, ignoring it\n", m->first, FEAR5_COUNT);
+                return false;
+            }
+            if (!golden_logged) {
+                golden_time_max = m->time_max;
+                fi_log_goldenrun(m->time, m->time_max);
+                fear5_stats_campaign_start();
+                golden_logged = true;
+            }
+            w->hello = true;
+            return true;
+        case F5_DIST_REQUEST:
+            if (!w->hello) {
+                return false;
+            }
+            w->waiting = true;
+            serve_range(w);
+            return true;
+        case F5_DIST_RESULT:
+            if (!w->hello || m->first < w->next || m->first >= w->last) {
+                return false;
+            }
+            w->next = m->first + 1;
+            if (test_and_set_bit(m->first, reported)) {
+                return true;
+            }
+            fear5_goto_mutant(m->first);
+            fi_log_mutant(m->time, golden_time_max, m->code);
+            fear5_stats_mutant_done(m->time, m->code);
+            completed++;
+            return true;
+    }
+    return false;
+}
+
+static void finish(void)
+{
+    Fear5DistMsg m = { .type = F5_DIST_DONE };
+
+    for (guint i = 0; i < workers->len; i++) {
+        Fear5DistWorker *w = g_ptr_array_index(workers, i);
+        msg_write(w->fd, &m);
+        close(w->fd);
+    }
+    fi_log_footer();
+    mutantlist_close();
+    exit(0);
+}
+
+void fear5_dist_coordinate(void)
+{
+    Error *err = NULL;
+    int listen_fd = -1;
+    SocketAddress *addr = socket_parse(coordinator_address, &err);
+
+    if (addr) {
+        listen_fd = socket_listen(addr, 16, &err);
+        qapi_free_SocketAddress(addr);
+    }
+    if (listen_fd < 0) {
+        error_reportf_err(err, "cannot listen on '%s': ", coordinator_address);
+        exit(1);
+    }
+
+    fi_log_header();
+    pending = g_array_new(FALSE, FALSE, sizeof(uint32_t));
+    workers = g_ptr_array_new();
+    reported = bitmap_new(MAX(FEAR5_COUNT, 1));
+    if (FEAR5_COUNT > 0) {
+        pending_push(0, FEAR5_COUNT, false);
+    }
+
+    while (completed < FEAR5_COUNT) {
+        guint n = workers->len;
+        struct pollfd *fds = g_new0(struct pollfd, n + 1);
+
+        fds[0].fd = listen_fd;
+        fds[0].events = POLLIN;
+        for (guint i = 0; i < n; i++) {
+            fds[i + 1].fd = ((Fear5DistWorker *) g_ptr_array_index(workers, i))->fd;
+            fds[i + 1].events = POLLIN;
+        }
+
+        if (poll(fds, n + 1, -1) < 0) {
+            g_free(fds);
+            if (errno == EINTR) {
+                continue;
+            }
+            perror("poll");
+            exit(1);
+        }
+
+        // Workers first, the array is only appended to by accept below.
+        // Handle every complete message; a worker that only sent part of
+        // one is looked at again when more arrives.
+        for (guint i = n; i > 0; i--) {
+            Fear5DistWorker *w = g_ptr_array_index(workers, i - 1);
+            Fear5DistMsg m;
+            int r = 0;
+
+            if (fds[i].revents) {
+                while ((r = msg_recv(w->fd, &w->in, &m)) > 0 && handle_msg(w, &m)) {
+                    /* next message */
+                }
+            }
+            if (r != 0) {
+                drop_worker(w);
+            }
+        }
+
+        if (fds[0].revents & POLLIN) {
+            int fd = qemu_accept(listen_fd, NULL, NULL);
+            if (fd >= 0) {
+                Fear5DistWorker *w = g_new0(Fear5DistWorker, 1);
+                qemu_set_nonblock(fd);
+                w->fd = fd;
+                g_ptr_array_add(workers, w);
+            }
+        }
+        g_free(fds);
+
+        // Serve workers still waiting, e.g. for a range that was re-queued
+        for (guint i = 0; i < workers->len; i++) {
+            Fear5DistWorker *w = g_ptr_array_index(workers, i);
+            if (w->waiting && !serve_range(w)) {
+                break;
+            }
+        }
+    }
+
+    close(listen_fd);
+    finish();
+}
@@ -2,7 +2,11 @@
 #include <math.h>
 #include <inttypes.h>
 #include "fear5/faultinjection.h"
+#include "fear5/dist.h"
 #include "fear5/logger.h"
+#include "fear5/sampling.h"
+#include "fear5/stats.h"
+#include "fear5/taint.h"
 
 #define FLUSH_DIV 1000
 static FILE *logfile = NULL;
@@ -17,6 +21,7 @@ static const char *mutant_result_text[] = {
     "interrupt",
     "missing isa extension",
     "non-zero exitcode",
+    "not killed (unreachable)",
 };
 
 // static const char *base_exceptions_text[] = {
@@ -104,8 +109,14 @@ void fi_log_footer(void) {
         logfile = stderr;
     }
 
-	fprintf(logfile, "#   Mutation testing finished. Simulated %d mutants.\n", FEAR5_COUNT);
-    fprintf(logfile, "#   TO DO: Footer with statistics and stuff like that...\n");
+    if (fear5_sampling_enabled()) {
+        fprintf(logfile, "#   Mutation testing finished. Simulated %d mutants.\n", fear5_sampling_count());
+        fear5_sampling_log(logfile);
+    } else {
+        fprintf(logfile, "#   Mutation testing finished. Simulated %d mutants.\n", FEAR5_COUNT);
+        fear5_stats_log(logfile);
+    }
+    fear5_cost_log(logfile);
 
     if (logfile != stderr) {
         //fflush(logfile);
@@ -130,7 +141,14 @@ void fi_log_goldenrun(uint64_t time, uint64_t time_max) {
     fprintf(logfile, "#    -> Mutants will timeout after %"PRIu64" us.\n#\n", time_max);
     fprintf(logfile, "#   TO DO: Display invocation parameters...\n#\n");
     fprintf(logfile, "#   Running %d mutants:\n", FEAR5_COUNT);
-    fprintf(logfile, "#   [%*s, %22s, %*s]\n", dIdx, "ID", "TEST RESULT", (dTim + 3), "TIME US");
+    if (fear5_cost_enabled()) {
+        fprintf(logfile, "#   [%*s, %22s, %*s, %12s, %8s, %7s, %10s, %8s]\n", dIdx, "ID", "TEST RESULT", (dTim + 3), "TIME US",
+                "INSNS", "TBS", "FLUSHES", "CPU US", "RESET US");
+    } else {
+        fprintf(logfile, "#   [%*s, %22s, %*s]\n", dIdx, "ID", "TEST RESULT", (dTim + 3), "TIME US");
+    }
+
+    fear5_dist_goldenrun(time, time_max);
 }
 
 void fi_log_mutant(uint64_t time, uint64_t time_max, uint32_t code) {
@@ -191,10 +209,23 @@ void fi_log_mutant(uint64_t time, uint64_t time_max, uint32_t code) {
     //         break;
     // }
 
-    fprintf(logfile, "     %0*d, %22s, %*"PRIu64" us\n",
-            dIdx, FEAR5_CURRENT->id,
-            txt,
-            dTim, time);
+    if (fear5_cost_enabled()) {
+        Fear5MutantCost c;
+        fear5_cost_get(&c);
+        fprintf(logfile, "     %0*d, %22s, %*"PRIu64" us, %12"PRIu64", %8"PRIu64", %7"PRIu64", %10"PRIu64", %8"PRIu64"\n",
+                dIdx, FEAR5_CURRENT->id,
+                txt,
+                dTim, time,
+                c.insns, c.tbs, c.flushes, c.cpu_ns / 1000, c.reset_ns / 1000);
+    } else {
+        fprintf(logfile, "     %0*d, %22s, %*"PRIu64" us\n",
+                dIdx, FEAR5_CURRENT->id,
+                txt,
+                dTim, time);
+    }
+    fear5_taint_log(logfile);
+
+    fear5_dist_result(time, code);
 
     flush_div = (flush_div + 1) % FLUSH_DIV;
     if (flush_div == 0) {
@@ -202,7 +233,7 @@ void fi_log_mutant(uint64_t time, uint64_t time_max, uint32_t code) {
 
         /* Display progress without too much slowdown... */
         if (logfile != stderr) {
-            int i = FEAR5_INDEX + 1;
+            int i = fear5_sampling_enabled() ? fear5_sampling_count() : FEAR5_INDEX + 1;
             float percent = (((float) i) / FEAR5_COUNT) * 100.0f;
             fprintf(stderr, "\r%0*d / %0*d (%03.02f %%)", dIdx, i, dIdx, FEAR5_COUNT, percent);
             fflush(stderr);
@@ -4,13 +4,19 @@
 #include <libxml/xpathInternals.h>
 #include <libxml/tree.h>
 #include "fear5/faultinjection.h"
+#include "fear5/dist.h"
 #include "fear5/parser.h"
+#include "fear5/sampling.h"
 #include <gio/gio.h>
 
 GFile *gfile;
 GInputStream *sbase;
 GDataInputStream *sdata;
 
+/* File offset and kind of every mutant line (for random access) */
+static GArray *line_offsets;
+static GArray *line_kinds;
+
 static int evalxpath(const char* xpath, xmlXPathContextPtr xpath_ctx, xmlXPathObjectPtr *xpath_obj, xmlNodeSetPtr *nodes)
 {
 	// Evaluate the expression
@@ -109,14 +115,22 @@ int mutantlist_load(const char *filename)
 	sdata = g_data_input_stream_new(g_buffered_input_stream_new(sbase));
 	assert(sdata);
 
-	// Count number of mutants...
+	// Count number of mutants and remember where each one starts...
 	int c = 0;
+	line_offsets = g_array_new(FALSE, FALSE, sizeof(goffset));
+	line_kinds = g_array_new(FALSE, FALSE, sizeof(int));
+	goffset pos = g_seekable_tell((GSeekable *) sdata);
 	char *line = g_data_input_stream_read_line(sdata, NULL, NULL, NULL);
 	while (line) {
 		if (line[0] != '#') {
+			int kind = 0;
+			sscanf(line, "%*d,%d", &kind);
+			g_array_append_val(line_offsets, pos);
+			g_array_append_val(line_kinds, kind);
 			c++;
 		}
 		g_free(line);
+		pos = g_seekable_tell((GSeekable *) sdata);
 		line = g_data_input_stream_read_line(sdata, NULL, NULL, NULL);
 	}
 
@@ -129,8 +143,32 @@ int mutantlist_load(const char *filename)
 	return 0;
 }
 
+static void parse_mutant(char *line)
+{
+	gchar **tok = g_strsplit(line, ",", -1);
+
+	sscanf(tok[0], "%d", &setup->current.id);
+	sscanf(tok[1], "%d", &setup->current.kind);
+	sscanf(tok[2], "%" PRIu64, &setup->current.addr_reg_mem);
+	sscanf(tok[3], "%" PRIu64, &setup->current.nr_access);
+	sscanf(tok[4], "%" PRIx64, &setup->current.biterror);
+
+	g_strfreev(tok);
+	g_free(line);
+}
+
 int fear5_gotonext_mutant(void) {
 
+	// Sampling mode draws the next mutant instead of reading on...
+	if (fear5_sampling_enabled()) {
+		return fear5_goto_mutant(fear5_sampling_next());
+	}
+
+	// ...and workers get theirs from the coordinator
+	if (fear5_dist_worker_enabled()) {
+		return fear5_goto_mutant(fear5_dist_next());
+	}
+
 	setup->m_index++;
 
 	// Get the next mutant line from CSV file....
@@ -146,21 +184,108 @@ int fear5_gotonext_mutant(void) {
 		//       of the mutant list file's memory...
 	}
 
-	// Parse it...
-	gchar **tok = g_strsplit(line, ",", -1);
+	parse_mutant(line);
+	return 0;
+}
 
-	sscanf(tok[0], "%d", &setup->current.id);
-	sscanf(tok[1], "%d", &setup->current.kind);
-	sscanf(tok[2], "%" PRIu64, &setup->current.addr_reg_mem);
-	sscanf(tok[3], "%" PRIu64, &setup->current.nr_access);
-	sscanf(tok[4], "%" PRIx64, &setup->current.biterror);
+int fear5_goto_mutant(int index) {
 
-	g_strfreev(tok);
-	g_free(line);
+	if (index < 0 || index >= setup->m_count) {
+		return 1;
+	}
+
+	g_seekable_seek((GSeekable *) sdata,
+	                g_array_index(line_offsets, goffset, index),
+	                G_SEEK_SET, NULL, NULL);
+	char *line = g_data_input_stream_read_line(sdata, NULL, NULL, NULL);
+	if (!line) {
+		return 1;
+	}
+
+	setup->m_index = index;
+	parse_mutant(line);
+	return 0;
+}
+
+int fear5_mutant_kind(int index) {
+	return g_array_index(line_kinds, int, index);
+}
+
+/* Golden run profile (-golden-profile), see qemu_fi_exit() for the format */
+static bool profile_loaded = false;
+static uint64_t profile_gpr[32];
+static uint64_t profile_csr[4096];
+static GHashTable *profile_exe;
+static GHashTable *profile_mem;
+
+int golden_profile_load(const char *filename)
+{
+	FILE *f = fopen(filename, "r");
+	char line[256];
 
+	if (!f) {
+		return 1;
+	}
+
+	profile_exe = g_hash_table_new(g_direct_hash, g_direct_equal);
+	profile_mem = g_hash_table_new(g_direct_hash, g_direct_equal);
+
+	while (fgets(line, sizeof(line), f)) {
+		unsigned idx, bits;
+		uint64_t addr, r, w, total;
+
+		if (sscanf(line, "GPR[%u]:%" SCNu64 ",%" SCNu64 ",%" SCNu64, &idx, &r, &w, &total) == 4 && idx < 32) {
+			profile_gpr[idx] = total;
+		} else if (sscanf(line, "CSR[%u]:%" SCNu64 ",%" SCNu64 ",%" SCNu64, &idx, &r, &w, &total) == 4 && idx < 4096) {
+			profile_csr[idx] = total;
+		} else if (sscanf(line, "EXE[%" SCNx64 "]:%" SCNu64, &addr, &total) == 2 && total) {
+			g_hash_table_add(profile_exe, GUINT_TO_POINTER(addr));
+		} else if (sscanf(line, "MEM_%u[%" SCNx64 "]:%" SCNu64 ",%" SCNu64 ",%" SCNu64, &bits, &addr, &r, &w, &total) == 5 && total) {
+			// Remember every byte covered by this access...
+			for (unsigned i = 0; i < bits / 8; i++) {
+				g_hash_table_add(profile_mem, GUINT_TO_POINTER(addr + i));
+			}
+		}
+	}
+	fclose(f);
+
+	profile_loaded = true;
 	return 0;
 }
 
+bool fear5_mutant_unreachable(Mutant *m)
+{
+	if (!profile_loaded || !m) {
+		return false;
+	}
+
+	switch (m->kind) {
+		case GPR_PERMANENT:
+		case GPR_STUCK_AT_ZERO:
+		case GPR_STUCK_AT_ONE:
+			return m->addr_reg_mem >= 32 || profile_gpr[m->addr_reg_mem] == 0;
+		case GPR_TRANSIENT:
+			return m->addr_reg_mem >= 32 || profile_gpr[m->addr_reg_mem] < m->nr_access;
+		case CSR_PERMANENT:
+		case CSR_STUCK_AT_ZERO:
+		case CSR_STUCK_AT_ONE:
+			return m->addr_reg_mem >= 4096 || profile_csr[m->addr_reg_mem] == 0;
+		case CSR_TRANSIENT:
+			return m->addr_reg_mem >= 4096 || profile_csr[m->addr_reg_mem] < m->nr_access;
+		case IMEM_PERMANENT:
+		case IMEM_STUCK_AT_ZERO:
+		case IMEM_STUCK_AT_ONE:
+			return !g_hash_table_contains(profile_exe, GUINT_TO_POINTER(m->addr_reg_mem));
+		case DMEM_PERMANENT:
+		case DMEM_TRANSIENT:
+		case DMEM_STUCK_AT_ZERO:
+		case DMEM_STUCK_AT_ONE:
+			return !g_hash_table_contains(profile_mem, GUINT_TO_POINTER(m->addr_reg_mem));
+	}
+	// IFR faults hit whatever is fetched
+	return false;
+}
+
 void mutantlist_close(void) {
 	if (sdata) g_object_unref(sdata);
 	if (sbase) g_object_unref(sbase);
@@ -0,0 +1,166 @@
+/*
+ * FEAR5 RAM snapshot (dirty-tracked reset)
+ *
+ * Copyright (c) 2022 Paderborn University, DE
+ *
+ * SPDX-License-Identifier: GPL-2.0-or-later
+ */
+
+#include "fear5/faultinjection.h"
+#include "fear5/ramsnap.h"
+#include "exec/ram_addr.h"
+#include "exec/ramblock.h"
+#include "exec/address-spaces.h"
+
+/*
+ * Copy of every RAMBlock as it was right after the images were loaded.
+ * Guest writes are tracked in the DIRTY_MEMORY_MIGRATION bitmap, so a
+ * reset only has to copy back the pages a run has actually written.
+ */
+typedef struct Fear5RamSnapshot {
+    RAMBlock *rb;
+    uint8_t *data;
+} Fear5RamSnapshot;
+
+static GList *snapshots = NULL;
+
+static int snapshot_block(RAMBlock *rb, void *opaque)
+{
+    Fear5RamSnapshot *s;
+
+    if (!rb->host || !rb->used_length) {
+        return 0;
+    }
+
+    s = g_new0(Fear5RamSnapshot, 1);
+    s->rb = rb;
+    s->data = g_malloc(rb->used_length);
+    memcpy(s->data, rb->host, rb->used_length);
+    snapshots = g_list_prepend(snapshots, s);
+
+    // Nothing is dirty with respect to the snapshot yet...
+    cpu_physical_memory_test_and_clear_dirty(rb->offset, rb->used_length,
+                                             DIRTY_MEMORY_MIGRATION);
+    return 0;
+}
+
+void fear5_ram_snapshot(void)
+{
+    // Only worth it when mutants follow the golden run
+    if (snapshots || !FEAR5_COUNT) {
+        return;
+    }
+
+    memory_global_dirty_log_start(GLOBAL_DIRTY_MIGRATION);
+    qemu_ram_foreach_block(snapshot_block, NULL);
+}
+
+static void restore_block(gpointer data, gpointer user_data)
+{
+    Fear5RamSnapshot *s = data;
+    RAMBlock *rb = s->rb;
+    DirtyBitmapSnapshot *snap;
+
+    snap = cpu_physical_memory_snapshot_and_clear_dirty(rb->mr, 0,
+                                                        rb->used_length,
+                                                        DIRTY_MEMORY_MIGRATION);
+
+    for (ram_addr_t off = 0; off < rb->used_length; off += TARGET_PAGE_SIZE) {
+        ram_addr_t addr = rb->offset + off;
+        ram_addr_t len = MIN(TARGET_PAGE_SIZE, rb->used_length - off);
+
+        if (!cpu_physical_memory_snapshot_get_dirty(snap, addr, len)) {
+            continue;
+        }
+        memcpy(rb->host + off, s->data + off, len);
+
+        // Drop translations of code that was written by the last run
+        if (!cpu_physical_memory_get_dirty_flag(addr, DIRTY_MEMORY_CODE)) {
+            tb_invalidate_phys_range(addr, addr + len);
+        }
+    }
+
+    g_free(snap);
+}
+
+bool fear5_ram_restore(void)
+{
+    if (!snapshots) {
+        return false;
+    }
+
+    WITH_RCU_READ_LOCK_GUARD() {
+        g_list_foreach(snapshots, restore_block, NULL);
+    }
+    return true;
+}
+
+/*
+ * IMEM faults are written to the instruction word in guest memory when a
+ * mutant starts, instead of being applied to every decoded instruction.
+ * The write invalidates all TBs covering the word, and the original value
+ * is written back before the next mutant.  There is no MMU in the FEAR5
+ * machines, so the mutant address is a physical address.
+ */
+static hwaddr imem_addr;
+static int imem_len = 0;
+static uint8_t imem_orig[4];
+
+void fear5_ram_patch_imem(void)
+{
+    Mutant *m = FEAR5_CURRENT;
+    uint8_t buf[4];
+    uint32_t val;
+    int len;
+
+    if (imem_len) {
+        address_space_write_rom(&address_space_memory, imem_addr,
+                                MEMTXATTRS_UNSPECIFIED, imem_orig, imem_len);
+        imem_len = 0;
+    }
+
+    if (!m || (m->kind != IMEM_PERMANENT && m->kind != IMEM_STUCK_AT_ZERO &&
+               m->kind != IMEM_STUCK_AT_ONE)) {
+        return;
+    }
+
+    /*
+     * The opcode tells the length of the instruction word: compressed
+     * instructions only have 16 bits to flip.
+     */
+    len = 2;
+    if (address_space_read(&address_space_memory, m->addr_reg_mem,
+                           MEMTXATTRS_UNSPECIFIED, buf, 2) == MEMTX_OK &&
+        (buf[0] & 3) == 3) {
+        len = 4;
+    }
+    if (address_space_read(&address_space_memory, m->addr_reg_mem,
+                           MEMTXATTRS_UNSPECIFIED, buf, len) != MEMTX_OK) {
+        fprintf(stderr, "WARNING: mutant %d: address %" PRIx64 " is not mapped!\n", m->id, m->addr_reg_mem);
+        return;
+    }
+    memcpy(imem_orig, buf, len);
+
+    val = len == 4 ? ldl_le_p(buf) : lduw_le_p(buf);
+    switch (m->kind) {
+        case IMEM_STUCK_AT_ZERO:
+            val &= ~m->biterror;
+            break;
+        case IMEM_STUCK_AT_ONE:
+            val |= m->biterror;
+            break;
+        default:
+            val ^= m->biterror;
+            break;
+    }
+    if (len == 4) {
+        stl_le_p(buf, val);
+    } else {
+        stw_le_p(buf, val);
+    }
+
+    address_space_write_rom(&address_space_memory, m->addr_reg_mem,
+                            MEMTXATTRS_UNSPECIFIED, buf, len);
+    imem_addr = m->addr_reg_mem;
+    imem_len = len;
+}
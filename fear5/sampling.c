@@ -0,0 +1,259 @@
+/*
+ * FEAR5 statistical fault sampling
+ *
+ * Copyright (c) 2022 Paderborn University, DE
+ *
+ * SPDX-License-Identifier: GPL-2.0-or-later
+ */
+
+#include <math.h>
+#include "fear5/faultinjection.h"
+#include "fear5/parser.h"
+#include "fear5/sampling.h"
+#include "fear5/stats.h"
+#include "qemu/option.h"
+
+/*
+ * Statistical fault sampling
+ *
+ * Mutants are drawn without replacement, either uniformly from the whole
+ * list or stratified by kind (proportional allocation).  After each run
+ * the result class proportions are estimated as
+ *
+ *   p = sum_h W_h * p_h,  var = sum_h W_h^2 * p_h (1 - p_h) / (n_h - 1)
+ *                                       * (1 - n_h / N_h)
+ *
+ * with the stratum weights W_h = N_h / N.  Sampling stops once the
+ * confidence interval of the kill rate is narrower than the requested
+ * width.
+ */
+
+typedef struct Fear5Stratum {
+    int kind;
+    GArray *idx;            /* list indices, [0, n) already drawn */
+    int n;
+    uint64_t count[RESULT__MAX];
+} Fear5Stratum;
+
+static bool enabled = false;
+static bool stratify = true;
+static double width = 0.05;
+static double confidence = 0.95;
+static double z;
+static int min_samples = 30;
+static GRand *rnd = NULL;
+
+static GArray *strata = NULL;
+static Fear5Stratum *current = NULL;
+static int samples = 0;
+
+static QemuOptsList fear5_sampling_opts = {
+    .name = "mutant-sampling",
+    .implied_opt_name = "width",
+    .head = QTAILQ_HEAD_INITIALIZER(fear5_sampling_opts.head),
+    .desc = {
+        {
+            .name = "width",
+            .type = QEMU_OPT_STRING,
+        }, {
+            .name = "confidence",
+            .type = QEMU_OPT_STRING,
+        }, {
+            .name = "stratify",
+            .type = QEMU_OPT_BOOL,
+        }, {
+            .name = "min",
+            .type = QEMU_OPT_NUMBER,
+        }, {
+            .name = "seed",
+            .type = QEMU_OPT_NUMBER,
+        },
+        { /* end of list */ }
+    },
+};
+
+void fear5_sampling_configure(const char *optarg)
+{
+    QemuOpts *opts = qemu_opts_parse_noisily(&fear5_sampling_opts, optarg,
+                                             true);
+    const char *s;
+
+    if (!opts) {
+        exit(1);
+    }
+    if ((s = qemu_opt_get(opts, "width"))) {
+        width = g_ascii_strtod(s, NULL);
+    }
+    if ((s = qemu_opt_get(opts, "confidence"))) {
+        confidence = g_ascii_strtod(s, NULL);
+    }
+    if (width <= 0 || width >= 1 || confidence <= 0 || confidence >= 1) {
+        fprintf(stderr, "ERROR: sampling width and confidence must be in (0, 1)!\n");
+        exit(1);
+    }
+    stratify = qemu_opt_get_bool(opts, "stratify", true);
+    min_samples = qemu_opt_get_number(opts, "min", 30);
+    rnd = g_rand_new_with_seed(qemu_opt_get_number(opts, "seed", 0));
+    qemu_opts_del(opts);
+
+    // z with erf(z / sqrt(2)) == confidence (two-sided normal quantile)
+    double lo = 0, hi = 10;
+    for (int i = 0; i < 64; i++) {
+        z = (lo + hi) / 2;
+        if (erf(z / M_SQRT2) < confidence) {
+            lo = z;
+        } else {
+            hi = z;
+        }
+    }
+
+    enabled = true;
+}
+
+bool fear5_sampling_enabled(void)
+{
+    return enabled;
+}
+
+int fear5_sampling_count(void)
+{
+    return samples;
+}
+
+static void init_strata(void)
+{
+    strata = g_array_new(FALSE, TRUE, sizeof(Fear5Stratum));
+    for (int i = 0; i < FEAR5_COUNT; i++) {
+        int kind = stratify ? fear5_mutant_kind(i) : 0;
+        Fear5Stratum *st = NULL;
+
+        for (guint h = 0; h < strata->len; h++) {
+            if (g_array_index(strata, Fear5Stratum, h).kind == kind) {
+                st = &g_array_index(strata, Fear5Stratum, h);
+                break;
+            }
+        }
+        if (!st) {
+            g_array_set_size(strata, strata->len + 1);
+            st = &g_array_index(strata, Fear5Stratum, strata->len - 1);
+            st->kind = kind;
+            st->idx = g_array_new(FALSE, FALSE, sizeof(int));
+        }
+        g_array_append_val(st->idx, i);
+    }
+}
+
+/* Estimate for a set of result classes and the half-width of its interval */
+static double estimate(unsigned mask, double *half)
+{
+    double p = 0, var = 0;
+
+    for (guint h = 0; h < strata->len; h++) {
+        Fear5Stratum *st = &g_array_index(strata, Fear5Stratum, h);
+        double N_h = st->idx->len;
+        double W_h = N_h / FEAR5_COUNT;
+        uint64_t c = 0;
+        double p_h;
+
+        if (st->n == 0) {
+            continue;
+        }
+        for (int k = 0; k < RESULT__MAX; k++) {
+            if (mask & (1u << k)) {
+                c += st->count[k];
+            }
+        }
+        p_h = (double) c / st->n;
+        p += W_h * p_h;
+        if (st->n > 1) {
+            var += W_h * W_h * p_h * (1 - p_h) / (st->n - 1) *
+                   (1 - st->n / N_h);
+        }
+    }
+
+    *half = z * sqrt(var);
+    return p;
+}
+
+static bool converged(void)
+{
+    double half;
+
+    if (samples < min_samples) {
+        return false;
+    }
+    // Every stratum needs a variance estimate before we can trust it
+    for (guint h = 0; h < strata->len; h++) {
+        Fear5Stratum *st = &g_array_index(strata, Fear5Stratum, h);
+        if (st->n < MIN(2, st->idx->len)) {
+            return false;
+        }
+    }
+    // Kill rate = 1 - P(not killed), so both share the same interval
+    estimate((1u << RESULT_NOT_KILLED) | (1u << RESULT_UNREACHABLE), &half);
+    return 2 * half <= width;
+}
+
+int fear5_sampling_next(void)
+{
+    Fear5Stratum *best = NULL;
+    double best_deficit = 0;
+
+    if (!strata) {
+        init_strata();
+    }
+    if (converged()) {
+        return -1;
+    }
+
+    // Proportional allocation: take the stratum that lags behind most
+    for (guint h = 0; h < strata->len; h++) {
+        Fear5Stratum *st = &g_array_index(strata, Fear5Stratum, h);
+        double deficit = (double) st->idx->len * (samples + 1) / FEAR5_COUNT
+                         - st->n;
+
+        if (st->n < st->idx->len && (!best || deficit > best_deficit)) {
+            best = st;
+            best_deficit = deficit;
+        }
+    }
+    if (!best) {
+        return -1;
+    }
+
+    // Partial Fisher-Yates shuffle: draw from the remaining indices
+    int j = g_rand_int_range(rnd, best->n, best->idx->len);
+    int *a = &g_array_index(best->idx, int, 0);
+    int tmp = a[j];
+    a[j] = a[best->n];
+    a[best->n] = tmp;
+    best->n++;
+
+    current = best;
+    samples++;
+    return tmp;
+}
+
+void fear5_sampling_record(uint32_t code)
+{
+    if (!enabled || !current) {
+        return;
+    }
+    current->count[fear5_result_class(code)]++;
+}
+
+void fear5_sampling_log(FILE *f)
+{
+    fprintf(f, "#   Sampled %d of %d mutants (%s, %.0f %% confidence):\n",
+            samples, FEAR5_COUNT, stratify ? "stratified by kind" : "uniform",
+            confidence * 100);
+    if (!strata) {
+        return;
+    }
+    for (int k = 0; k < RESULT__MAX; k++) {
+        double half;
+        double p = estimate(1u << k, &half);
+        fprintf(f, "#     %-18s %6.02f %% +/- %.02f %%\n",
+                fear5_result_class_text[k], p * 100, half * 100);
+    }
+}
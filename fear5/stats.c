@@ -0,0 +1,286 @@
+/*
+ * FEAR5 campaign statistics
+ *
+ * Copyright (c) 2022 Paderborn University, DE
+ *
+ * SPDX-License-Identifier: GPL-2.0-or-later
+ */
+
+#include "fear5/faultinjection.h"
+#include "fear5/dist.h"
+#include "fear5/parser.h"
+#include "fear5/sampling.h"
+#include "fear5/stats.h"
+#include "qemu/stats64.h"
+#ifndef CONFIG_USER_ONLY
+#include "qapi/error.h"
+#include "qapi/qapi-commands-misc-target.h"
+#include "sysemu/runstate.h"
+#endif
+
+// Counters are updated from the vCPU/reset path and read by QMP without
+// taking any lock; Stat64 falls back to a spinlock only on hosts without
+// 64-bit atomics.
+static Stat64 completed;
+static Stat64 results[RESULT__MAX];
+static Stat64 runtime_us;
+static Stat64 reset_ns;
+static int64_t campaign_start_ns;
+
+// When the last mutant was killed, 0 before the first one.  Only used on
+// the reset path, between killing a mutant and starting the next.
+static int64_t killed_ns;
+
+#ifndef CONFIG_USER_ONLY
+static bool pause_requested;
+#endif
+static int skip_to = -1;
+
+// Per-mutant cost accounting, only while a mutant runs
+#define COST_KINDS 100
+
+uintptr_t fear5_cost_insns;
+uint64_t fear5_cost_tbs;
+static bool cost_enabled;
+static Fear5MutantCost cost_start;
+static Fear5MutantCost cost_last;
+static Fear5MutantCost cost_sum[COST_KINDS];
+static uint64_t cost_count[COST_KINDS];
+
+static inline int64_t host_now_ns(void)
+{
+    return qemu_clock_get_ns(QEMU_CLOCK_HOST);
+}
+
+const char *fear5_result_class_text[RESULT__MAX] = {
+    "not killed",
+    "signature",
+    "timeout",
+    "exception",
+    "non-zero exitcode",
+    "not killed (unreachable)",
+};
+
+enum Fear5ResultClass fear5_result_class(uint32_t code)
+{
+    if (code & EXCEPTION) {
+        return RESULT_EXCEPTION;
+    }
+    switch (code) {
+        case NOT_KILLED:
+            return RESULT_NOT_KILLED;
+        case OUTPUT_DEVIATION:
+            return RESULT_SIGNATURE;
+        case TIMEOUT:
+            return RESULT_TIMEOUT;
+        case UNREACHABLE:
+            return RESULT_UNREACHABLE;
+        default:
+            return RESULT_EXIT_FAIL;
+    }
+}
+
+void fear5_stats_campaign_start(void)
+{
+    campaign_start_ns = host_now_ns();
+}
+
+static uint64_t cpu_now_ns(void)
+{
+    struct timespec ts;
+
+    clock_gettime(CLOCK_PROCESS_CPUTIME_ID, &ts);
+    return ts.tv_sec * 1000000000ULL + ts.tv_nsec;
+}
+
+void fear5_stats_mutant_killed(void)
+{
+    killed_ns = host_now_ns();
+    fear5_cost_end();
+}
+
+void fear5_stats_mutant_done(uint64_t time, uint32_t code)
+{
+    stat64_add(&results[fear5_result_class(code)], 1);
+    stat64_add(&runtime_us, time);
+    stat64_add(&completed, 1);
+
+    if (cost_enabled) {
+        Mutant *m = FEAR5_CURRENT;
+        int kind = (m && m->kind >= 0 && m->kind < COST_KINDS) ? m->kind : 0;
+
+        cost_sum[kind].insns += cost_last.insns;
+        cost_sum[kind].tbs += cost_last.tbs;
+        cost_sum[kind].flushes += cost_last.flushes;
+        cost_sum[kind].cpu_ns += cost_last.cpu_ns;
+        cost_sum[kind].reset_ns += cost_last.reset_ns;
+        cost_count[kind]++;
+
+        // Unreachable mutants are logged without running
+        memset(&cost_last, 0, sizeof(cost_last));
+    }
+}
+
+void fear5_stats_mutant_started(void)
+{
+    int64_t reset = killed_ns ? host_now_ns() - killed_ns : 0;
+
+    if (killed_ns) {
+        stat64_add(&reset_ns, reset);
+    }
+
+    if (cost_enabled) {
+        cost_start.insns = fear5_cost_insns;
+        cost_start.tbs = fear5_cost_tbs;
+        cost_start.flushes = tb_get_flush_count();
+        cost_start.cpu_ns = cpu_now_ns();
+        cost_start.reset_ns = reset;
+    }
+}
+
+void fear5_cost_enable(void)
+{
+    cost_enabled = true;
+}
+
+bool fear5_cost_enabled(void)
+{
+    return cost_enabled;
+}
+
+void fear5_cost_end(void)
+{
+    if (!cost_enabled || f5->phase != MUTANT) {
+        return;
+    }
+    // uintptr_t may wrap on 32-bit hosts, the difference is still right
+    cost_last.insns = (uintptr_t) (fear5_cost_insns - cost_start.insns);
+    cost_last.tbs = fear5_cost_tbs - cost_start.tbs;
+    cost_last.flushes = (unsigned) (tb_get_flush_count() - cost_start.flushes);
+    cost_last.cpu_ns = cpu_now_ns() - cost_start.cpu_ns;
+    cost_last.reset_ns = cost_start.reset_ns;
+}
+
+void fear5_cost_get(Fear5MutantCost *c)
+{
+    *c = cost_last;
+}
+
+void fear5_cost_set(const Fear5MutantCost *c)
+{
+    cost_last = *c;
+}
+
+void fear5_cost_log(FILE *f)
+{
+    if (!cost_enabled) {
+        return;
+    }
+
+    fprintf(f, "#   Average cost per mutant kind:\n");
+    fprintf(f, "#     %4s %8s %14s %8s %8s %12s %10s\n",
+            "KIND", "COUNT", "INSNS", "TBS", "FLUSHES", "CPU US", "RESET US");
+    for (int k = 0; k < COST_KINDS; k++) {
+        uint64_t n = cost_count[k];
+        if (!n) {
+            continue;
+        }
+        fprintf(f, "#     %4d %8" PRIu64 " %14.1f %8.1f %8.2f %12.1f %10.1f\n",
+                k, n, (double) cost_sum[k].insns / n,
+                (double) cost_sum[k].tbs / n,
+                (double) cost_sum[k].flushes / n,
+                cost_sum[k].cpu_ns / 1e3 / n,
+                cost_sum[k].reset_ns / 1e3 / n);
+    }
+}
+
+void fear5_stats_select_next(void)
+{
+    // Skip ahead: the mutant at index skip_to is selected by the regular
+    // fear5_gotonext_mutant() call that follows.
+    int target = qatomic_xchg(&skip_to, -1);
+    while (target > 0 && FEAR5_INDEX + 1 < target) {
+        if (fear5_gotonext_mutant()) {
+            break;
+        }
+    }
+
+#ifndef CONFIG_USER_ONLY
+    if (qatomic_xchg(&pause_requested, false)) {
+        qemu_system_vmstop_request_prepare();
+        qemu_system_vmstop_request(RUN_STATE_PAUSED);
+    }
+#endif
+}
+
+void fear5_stats_log(FILE *f)
+{
+    uint64_t n = stat64_get(&completed);
+
+    fprintf(f, "#   Results:\n");
+    for (int k = 0; k < RESULT__MAX; k++) {
+        uint64_t c = stat64_get(&results[k]);
+        fprintf(f, "#     %-18s %8" PRIu64 " (%6.02f %%)\n",
+                fear5_result_class_text[k], c, n ? 100.0 * c / n : 0.0);
+    }
+}
+
+// There is no monitor in linux-user mode
+#ifndef CONFIG_USER_ONLY
+Fear5CampaignInfo *qmp_query_fear5_campaign(Error **errp)
+{
+    Fear5CampaignInfo *info = g_new0(Fear5CampaignInfo, 1);
+    uint64_t n = stat64_get(&completed);
+    int64_t elapsed = campaign_start_ns ? host_now_ns() - campaign_start_ns : 0;
+
+    info->golden_run = f5 && f5->phase != MUTANT;
+    info->total = FEAR5_COUNT;
+    info->current = FEAR5_INDEX;
+    info->completed = n;
+    info->paused = !runstate_is_running();
+    info->mutants_per_second = elapsed > 0 ? n * 1e9 / elapsed : 0;
+    info->avg_runtime_us = n ? (double)stat64_get(&runtime_us) / n : 0;
+    info->avg_reset_overhead_us = n ? stat64_get(&reset_ns) / 1e3 / n : 0;
+
+    info->results = g_new0(Fear5ResultCounts, 1);
+    info->results->not_killed = stat64_get(&results[RESULT_NOT_KILLED]);
+    info->results->signature = stat64_get(&results[RESULT_SIGNATURE]);
+    info->results->timeout = stat64_get(&results[RESULT_TIMEOUT]);
+    info->results->exception = stat64_get(&results[RESULT_EXCEPTION]);
+    info->results->exit_fail = stat64_get(&results[RESULT_EXIT_FAIL]);
+    info->results->unreachable = stat64_get(&results[RESULT_UNREACHABLE]);
+
+    return info;
+}
+
+void qmp_fear5_pause(Error **errp)
+{
+    if (!FEAR5_COUNT) {
+        error_setg(errp, "No mutation testing campaign is running");
+        return;
+    }
+    qatomic_set(&pause_requested, true);
+}
+
+void qmp_fear5_skip_to(int64_t index, Error **errp)
+{
+    if (!FEAR5_COUNT) {
+        error_setg(errp, "No mutation testing campaign is running");
+        return;
+    }
+    if (fear5_sampling_enabled()) {
+        error_setg(errp, "Cannot skip mutants in sampling mode");
+        return;
+    }
+    if (fear5_dist_worker_enabled()) {
+        error_setg(errp, "Cannot skip mutants handed out by a coordinator");
+        return;
+    }
+    if (index <= FEAR5_INDEX || index >= FEAR5_COUNT) {
+        error_setg(errp, "Mutant index must be in the range %d..%d",
+                   FEAR5_INDEX + 1, FEAR5_COUNT - 1);
+        return;
+    }
+    qatomic_set(&skip_to, index);
+}
+#endif
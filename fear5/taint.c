@@ -0,0 +1,130 @@
+/*
+ * FEAR5 fault-effect (taint) tracking
+ *
+ * Copyright (c) 2022 Paderborn University, DE
+ *
+ * SPDX-License-Identifier: GPL-2.0-or-later
+ */
+
+#include "fear5/faultinjection.h"
+#include "fear5/taint.h"
+#include "cpu.h"
+
+Fear5TaintState fear5_taint;
+
+static bool enabled = false;
+static Fear5TaintSummary last;
+
+void fear5_taint_enable(void)
+{
+    enabled = true;
+}
+
+bool fear5_taint_enabled(void)
+{
+    return enabled;
+}
+
+/*
+ * Taint the fault location of the new mutant.  Transient faults (and all
+ * CSR and DMEM faults) are tainted where they are applied instead.
+ */
+void fear5_taint_begin(void)
+{
+    Mutant *m = FEAR5_CURRENT;
+
+    if (!enabled) {
+        return;
+    }
+    memset(&fear5_taint, 0, sizeof(fear5_taint));
+    memset(&last, 0, sizeof(last));
+
+    if (!m) {
+        return;
+    }
+    switch (m->kind) {
+        case GPR_PERMANENT:
+        case GPR_STUCK_AT_ZERO:
+        case GPR_STUCK_AT_ONE:
+            if (m->addr_reg_mem > 0 && m->addr_reg_mem < 32) {
+                fear5_taint.gpr |= 1u << m->addr_reg_mem;
+            }
+            break;
+        case IMEM_PERMANENT:
+        case IMEM_STUCK_AT_ZERO:
+        case IMEM_STUCK_AT_ONE:
+            fear5_taint_mem(m->addr_reg_mem);
+            break;
+    }
+}
+
+void fear5_taint_mem(uint64_t addr)
+{
+    fear5_taint.mem[(addr >> F5_TAINT_PAGE_BITS) & (F5_TAINT_PAGES - 1)] = 1;
+}
+
+/* Called for stores to monitored addresses while fear5_taint.st is set */
+void fear5_taint_monitor_store(CPUState *cs, uint64_t addr, uintptr_t retaddr)
+{
+    CPURISCVState *env = cs->env_ptr;
+
+    if (last.stored) {
+        return;
+    }
+    cpu_restore_state(cs, retaddr, false);
+    last.stored = 1;
+    last.store_addr = addr;
+    last.store_pc = env->pc;
+}
+
+void fear5_taint_end(void)
+{
+    if (!enabled || f5->phase != MUTANT) {
+        return;
+    }
+
+    last.valid = 1;
+    last.gpr = fear5_taint.gpr & ~1u;
+    last.csrs = 0;
+    for (int i = 0; i < ARRAY_SIZE(fear5_taint.csr); i++) {
+        last.csrs += fear5_taint.csr[i] != 0;
+    }
+    last.pages = 0;
+    for (int i = 0; i < F5_TAINT_PAGES; i += 8) {
+        // Mostly clean, so skip eight pages at a time
+        if (ldq_he_p(&fear5_taint.mem[i])) {
+            for (int j = i; j < i + 8; j++) {
+                last.pages += fear5_taint.mem[j] != 0;
+            }
+        }
+    }
+}
+
+void fear5_taint_get(Fear5TaintSummary *s)
+{
+    *s = last;
+}
+
+void fear5_taint_set(const Fear5TaintSummary *s)
+{
+    last = *s;
+}
+
+void fear5_taint_log(FILE *f)
+{
+    if (!last.valid) {
+        return;
+    }
+
+    fprintf(f, "#       taint: gpr=0x%08" PRIx32 ", csrs=%" PRIu32 ", pages=%" PRIu32,
+            last.gpr, last.csrs, last.pages);
+    if (last.stored) {
+        fprintf(f, ", first store to 0x%" PRIx64 " at pc 0x%" PRIx64 "\n",
+                last.store_addr, last.store_pc);
+    } else {
+        fprintf(f, ", no tainted store\n");
+    }
+
+    // Unreachable mutants are logged without running
+    memset(&last, 0, sizeof(last));
+}
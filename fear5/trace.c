@@ -0,0 +1,146 @@
+/*
+ * FEAR5 compressed execution trace
+ *
+ * Copyright (c) 2022 Paderborn University, DE
+ *
+ * SPDX-License-Identifier: GPL-2.0-or-later
+ */
+
+#include <stdio.h>
+#include <string.h>
+#include <inttypes.h>
+#include "fear5/faultinjection.h"
+#include "fear5/trace.h"
+
+#define TRACE_BUFSIZE (1 << 20)
+
+static char *trace_path = NULL;
+static FILE *trace_file = NULL;
+static uint64_t nr_records = 0;
+static uint64_t offset = 0;
+static uint64_t last_pc = 0;
+static uint64_t last_gpr[32];
+static GArray *trace_index = NULL;
+
+void fear5_exec_trace_set_path(const char *path)
+{
+    g_free(trace_path);
+    trace_path = g_strdup(path);
+}
+
+bool fear5_exec_trace_enabled(void)
+{
+    return trace_path != NULL;
+}
+
+static void put_u64(uint64_t v)
+{
+    uint8_t buf[8];
+    for (int i = 0; i < 8; i++) {
+        buf[i] = v >> (8 * i);
+    }
+    fwrite(buf, 1, 8, trace_file);
+    offset += 8;
+}
+
+static void put_varint(uint64_t v)
+{
+    uint8_t buf[10];
+    int n = 0;
+    while (v >= 0x80) {
+        buf[n++] = (v & 0x7f) | 0x80;
+        v >>= 7;
+    }
+    buf[n++] = v;
+    fwrite(buf, 1, n, trace_file);
+    offset += n;
+}
+
+static inline uint64_t zigzag(uint64_t delta)
+{
+    return (delta << 1) ^ (uint64_t)((int64_t)delta >> 63);
+}
+
+static void next_record(void)
+{
+    // Start a new block: remember where it begins and drop the delta state,
+    // so that every block decodes on its own.
+    if ((nr_records % F5_TRACE_BLOCK) == 0) {
+        uint64_t entry[2] = { nr_records, offset };
+        g_array_append_vals(trace_index, entry, 2);
+        last_pc = 0;
+        memset(last_gpr, 0, sizeof(last_gpr));
+    }
+    nr_records++;
+}
+
+void fear5_exec_trace_begin(void)
+{
+    if (!trace_path) {
+        return;
+    }
+    fear5_exec_trace_end();
+
+    // The golden run goes to the given file, every mutant to <file>.<id>
+    Mutant *m = FEAR5_CURRENT;
+    char *path = (f5->phase == MUTANT && m) ?
+                 g_strdup_printf("%s.%d", trace_path, m->id) :
+                 g_strdup(trace_path);
+
+    trace_file = fopen(path, "wb");
+    if (!trace_file) {
+        fprintf(stderr, "ERROR: cannot open trace file '%s'!\n", path);
+        exit(1);
+    }
+    g_free(path);
+    setvbuf(trace_file, NULL, _IOFBF, TRACE_BUFSIZE);
+
+    if (!trace_index) {
+        trace_index = g_array_new(FALSE, FALSE, sizeof(uint64_t));
+    }
+    g_array_set_size(trace_index, 0);
+    nr_records = 0;
+    offset = 0;
+
+    fwrite(F5_TRACE_MAGIC, 1, 8, trace_file);
+    offset += 8;
+}
+
+void fear5_exec_trace_end(void)
+{
+    if (!trace_file) {
+        return;
+    }
+
+    uint64_t index_offset = offset;
+    for (guint i = 0; i < trace_index->len; i++) {
+        put_u64(g_array_index(trace_index, uint64_t, i));
+    }
+    put_u64(trace_index->len / 2);
+    put_u64(index_offset);
+    fwrite(F5_TRACE_IDX_MAGIC, 1, 8, trace_file);
+
+    fclose(trace_file);
+    trace_file = NULL;
+}
+
+void fear5_exec_trace_pc(uint64_t pc)
+{
+    if (unlikely(!trace_file)) {
+        return;
+    }
+    next_record();
+    put_varint(zigzag(pc - last_pc) << 1);
+    last_pc = pc;
+}
+
+void fear5_exec_trace_gpr(unsigned idx, uint64_t val)
+{
+    if (unlikely(!trace_file)) {
+        return;
+    }
+    next_record();
+    put_varint((idx << 1) | 1);
+    put_varint(zigzag(val - last_gpr[idx]));
+    last_gpr[idx] = val;
+}
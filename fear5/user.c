@@ -0,0 +1,322 @@
+/*
+ * FEAR5 mutation testing in linux-user mode
+ *
+ * Copyright (c) 2022 Paderborn University, DE
+ *
+ * SPDX-License-Identifier: GPL-2.0-or-later
+ */
+
+#include "fear5/faultinjection.h"
+#include "fear5/dist.h"
+#include "fear5/logger.h"
+#include "fear5/parser.h"
+#include "fear5/sampling.h"
+#include "fear5/stats.h"
+#include "fear5/taint.h"
+#include "fear5/trace.h"
+#include "fear5/user.h"
+#include "qemu/cutils.h"
+#include "qemu/log.h"
+#include "qemu.h"
+#include "user-internals.h"
+#include "loader.h"
+#include <sys/wait.h>
+
+#define WAIT_POLL_US 100
+
+// Sent by the child through the result pipe when it exits
+typedef struct Fear5UserResult {
+    uint32_t killed;        // code was reported through fear5_user_kill()
+    uint32_t code;
+    Fear5MutantCost cost;
+    Fear5TaintSummary taint;
+} Fear5UserResult;
+
+typedef struct Fear5UserRun {
+    int status;             // as returned by waitpid()
+    bool timeout;
+    bool killed;
+    uint32_t code;
+    uint64_t time;          // wall clock time in us
+    GByteArray *output;     // everything written to stdout
+    Fear5MutantCost cost;
+    Fear5TaintSummary taint;
+} Fear5UserRun;
+
+static const char *entry_name = "main";
+static target_ulong entry_pc;
+static bool entry_armed = false;
+static off_t stdin_offset = -1;
+static int result_fd = -1;
+static Fear5UserResult result;
+
+void fear5_user_set_entry(const char *entry)
+{
+    entry_name = entry;
+}
+
+void fear5_user_start(CPUArchState *env)
+{
+    uint64_t addr;
+
+    if (!FEAR5_COUNT) {
+        return;
+    }
+    if (fear5_dist_worker_enabled() && fear5_sampling_enabled()) {
+        fprintf(stderr, "ERROR: -mutant-sampling cannot be used in distributed campaigns!\n");
+        exit(1);
+    }
+
+    if (qemu_strtou64(entry_name, NULL, 0, &addr) == 0) {
+        entry_pc = addr;
+    } else if (!elf_lookup_symbol(entry_name, &entry_pc)) {
+        fprintf(stderr, "ERROR: cannot find symbol '%s', use -mutant-entry <address>!\n", entry_name);
+        exit(1);
+    }
+
+    cpu_breakpoint_insert(env_cpu(env), entry_pc, BP_GDB, NULL);
+    entry_armed = true;
+}
+
+static int open_output(void)
+{
+    GError *err = NULL;
+    char *path;
+
+    int fd = g_file_open_tmp("fear5-XXXXXX", &path, &err);
+    if (fd < 0) {
+        fprintf(stderr, "ERROR: cannot create output file: %s\n", err->message);
+        exit(1);
+    }
+    unlink(path);
+    g_free(path);
+    return fd;
+}
+
+static GByteArray *read_output(int fd)
+{
+    GByteArray *buf = g_byte_array_new();
+    uint8_t chunk[4096];
+    ssize_t n;
+
+    lseek(fd, 0, SEEK_SET);
+    while ((n = read(fd, chunk, sizeof(chunk))) > 0) {
+        g_byte_array_append(buf, chunk, n);
+    }
+    return buf;
+}
+
+static void wait_run(pid_t pid, int64_t start, uint64_t time_max, Fear5UserRun *r)
+{
+    r->timeout = false;
+    for (;;) {
+        pid_t ret = waitpid(pid, &r->status, WNOHANG);
+        int64_t now = g_get_monotonic_time();
+
+        if (ret == pid) {
+            r->time = now - start;
+            return;
+        }
+        if (ret < 0 && errno != EINTR) {
+            perror("waitpid");
+            exit(1);
+        }
+        if (time_max && now - start > time_max) {
+            kill(pid, SIGKILL);
+            waitpid(pid, &r->status, 0);
+            r->timeout = true;
+            r->time = now - start;
+            return;
+        }
+        g_usleep(WAIT_POLL_US);
+    }
+}
+
+/*
+ * Fork a child for the next run.  Returns true in the child, which goes on
+ * simulating the guest, and false in the parent once the child is done.
+ */
+static bool fork_run(Fear5UserRun *r, uint64_t time_max)
+{
+    int out = open_output();
+    int result[2];
+
+    if (pipe(result)) {
+        perror("pipe");
+        exit(1);
+    }
+    if (stdin_offset >= 0) {
+        lseek(STDIN_FILENO, stdin_offset, SEEK_SET);
+    }
+    // Children must not flush a copy of our buffers (e.g. the test report)
+    fflush(NULL);
+
+    // Same locking as for a guest fork(), see do_fork()
+    int64_t start = g_get_monotonic_time();
+    fork_start();
+    pid_t pid = fork();
+    if (pid < 0) {
+        perror("fork");
+        exit(1);
+    }
+    if (pid == 0) {
+        fork_end(1);
+        close(result[0]);
+        result_fd = result[1];
+        dup2(out, STDOUT_FILENO);
+        close(out);
+        return true;
+    }
+
+    fork_end(0);
+    close(result[1]);
+    wait_run(pid, start, time_max, r);
+
+    // Nothing is sent by children killed on timeout
+    Fear5UserResult res = { 0 };
+    if (read(result[0], &res, sizeof(res)) != sizeof(res)) {
+        memset(&res, 0, sizeof(res));
+    }
+    r->killed = res.killed;
+    r->code = res.code;
+    r->cost = res.cost;
+    r->taint = res.taint;
+    close(result[0]);
+    r->output = read_output(out);
+    close(out);
+    return false;
+}
+
+static uint32_t classify(Fear5UserRun *r, Fear5UserRun *golden)
+{
+    if (r->killed) {
+        return r->code;
+    }
+    if (r->timeout) {
+        return TIMEOUT;
+    }
+    if (WIFSIGNALED(r->status)) {
+        return EXCEPTION | WTERMSIG(r->status);
+    }
+    if (WEXITSTATUS(r->status) != WEXITSTATUS(golden->status)) {
+        return EXIT_FAIL;
+    }
+    if (r->output->len != golden->output->len ||
+        memcmp(r->output->data, golden->output->data, r->output->len)) {
+        return OUTPUT_DEVIATION;
+    }
+    return NOT_KILLED;
+}
+
+static void start_child(void)
+{
+    fear5_taint_begin();
+    fear5_exec_trace_begin();
+    fear5_stats_mutant_started();
+}
+
+/* Returns in the child processes only */
+static void fork_server(CPUState *cs)
+{
+    Fear5UserRun golden = { 0 };
+    Fear5UserRun run = { 0 };
+    uint64_t runTimeMax;
+
+    stdin_offset = lseek(STDIN_FILENO, 0, SEEK_CUR);
+
+    // Translations made so far are shared by all runs, but must be looked
+    // up again with the fault key of the mutant.  The golden run statistics
+    // are only gathered by translations made in the golden run itself...
+    start_exclusive();
+    if (qemu_loglevel_mask(FEAR5_LOG_GOLDENRUN)) {
+        tb_flush(cs);
+    } else {
+        tb_unlink_all(cs);
+    }
+    end_exclusive();
+
+    // Golden run
+    f5->phase = GOLDEN_RUN;
+    fear5_update_tb_key();
+    if (fork_run(&golden, 0)) {
+        start_child();
+        return;
+    }
+    if (golden.timeout || (golden.killed && golden.code != NOT_KILLED) ||
+        !WIFEXITED(golden.status)) {
+        qemu_fi_exit(1, "ERROR: Golden Run has errors! Fix this or use another test program.");
+    }
+    runTimeMax = (f5_get_timeout_factor() * golden.time) + f5_get_timeout_us_extra();
+    fi_log_goldenrun(golden.time, runTimeMax);
+    fear5_stats_campaign_start();
+    f5->phase = MUTANT;
+
+    // Mutants
+    while (!fear5_gotonext_mutant()) {
+        uint32_t code = UNREACHABLE;
+
+        run.time = 0;
+        if (!fear5_mutant_unreachable(FEAR5_CURRENT)) {
+            fear5_update_tb_key();
+            if (fork_run(&run, runTimeMax)) {
+                start_child();
+                return;
+            }
+            code = classify(&run, &golden);
+            g_byte_array_unref(run.output);
+            fear5_cost_set(&run.cost);
+            fear5_taint_set(&run.taint);
+        }
+        fi_log_mutant(run.time, runTimeMax, code);
+        fear5_stats_mutant_done(run.time, code);
+        fear5_sampling_record(code);
+    }
+
+    fi_log_footer();
+    mutantlist_close();
+    exit(0);
+}
+
+bool fear5_user_entry_reached(CPUArchState *env)
+{
+    CPUState *cs = env_cpu(env);
+
+    if (!entry_armed || env->pc != entry_pc) {
+        return false;
+    }
+    entry_armed = false;
+    cpu_breakpoint_remove(cs, entry_pc, BP_GDB);
+
+    fork_server(cs);
+    return true;
+}
+
+void fear5_user_kill(uint32_t code)
+{
+    result.killed = true;
+    result.code = code;
+    fear5_user_exit();
+    _exit(0);
+}
+
+void fear5_user_exit(void)
+{
+    if (f5->phase != MUTANT && qemu_loglevel_mask(FEAR5_LOG_GOLDENRUN)) {
+        fear5_log_golden_stats();
+        qemu_log_flush();
+    }
+    fear5_exec_trace_end();
+
+    // Only runs forked by the fork server report a result
+    if (result_fd >= 0) {
+        fear5_cost_end();
+        fear5_cost_get(&result.cost);
+        fear5_taint_end();
+        fear5_taint_get(&result.taint);
+        if (write(result_fd, &result, sizeof(result)) != sizeof(result)) {
+            fprintf(stderr, "ERROR: cannot report mutant result!\n");
+        }
+        close(result_fd);
+        result_fd = -1;
+    }
+}
@@ -25,6 +25,9 @@
 #include "hw/irq.h"
 #include "hw/char/sifive_uart.h"
 #include "hw/qdev-properties-system.h"
+#ifdef CONFIG_FEAR5
+#include "fear5/devsnap.h"
+#endif
 
 /*
  * Not yet implemented:
@@ -193,6 +196,13 @@ static void sifive_uart_init(Object *obj)
     sysbus_init_irq(sbd, &s->irq);
 }
 
+#ifdef CONFIG_FEAR5
+static void sifive_uart_restore(DeviceState *dev)
+{
+    sifive_uart_update_irq(SIFIVE_UART(dev));
+}
+#endif
+
 static void sifive_uart_realize(DeviceState *dev, Error **errp)
 {
     SiFiveUARTState *s = SIFIVE_UART(dev);
@@ -201,6 +211,10 @@ static void sifive_uart_realize(DeviceState *dev, Error **errp)
                              sifive_uart_event, sifive_uart_be_change, s,
                              NULL, true);
 
+#ifdef CONFIG_FEAR5
+    fear5_devsnap_register(dev, FEAR5_DEVSNAP_RANGE(s, rx_fifo, div),
+                           sifive_uart_restore);
+#endif
 }
 
 static void sifive_uart_reset_enter(Object *obj, ResetType type)
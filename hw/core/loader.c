@@ -62,6 +62,9 @@
 #include "hw/boards.h"
 #include "qemu/cutils.h"
 #include "sysemu/runstate.h"
+#ifdef CONFIG_FEAR5
+#include "fear5/ramsnap.h"
+#endif
 
 #include <zlib.h>
 
@@ -1138,6 +1141,16 @@ static void rom_reset(void *unused)
 {
     Rom *rom;
 
+#ifdef CONFIG_FEAR5
+    /*
+     * Once the images are in place, a mutant reset only copies back the
+     * RAM pages the previous run has written (see fear5/ramsnap.c).
+     */
+    if (fear5_ram_restore()) {
+        return;
+    }
+#endif
+
     QTAILQ_FOREACH(rom, &roms, next) {
         if (rom->fw_file) {
             continue;
@@ -1186,6 +1199,12 @@ static void rom_reset(void *unused)
 
         trace_loader_write_rom(rom->name, rom->addr, rom->datasize, rom->isrom);
     }
+
+#ifdef CONFIG_FEAR5
+    if (!runstate_check(RUN_STATE_INMIGRATE)) {
+        fear5_ram_snapshot();
+    }
+#endif
 }
 
 /* Return true if two consecutive ROMs in the ROM list overlap */
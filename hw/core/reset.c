@@ -70,3 +70,15 @@ void qemu_devices_reset(void)
     }
 }
 
+/* Like qemu_devices_reset(), but skip the handler @func with @opaque */
+void qemu_devices_reset_except(QEMUResetHandler *func, void *opaque)
+{
+    QEMUResetEntry *re, *nre;
+
+    QTAILQ_FOREACH_SAFE(re, &reset_handlers, entry, nre) {
+        if (re->func != func || re->opaque != opaque) {
+            re->func(re->opaque);
+        }
+    }
+}
+
@@ -18,6 +18,9 @@
 #include "hw/gpio/sifive_gpio.h"
 #include "migration/vmstate.h"
 #include "trace.h"
+#ifdef CONFIG_FEAR5
+#include "fear5/devsnap.h"
+#endif
 
 static void update_output_irq(SIFIVEGPIOState *s)
 {
@@ -354,6 +357,13 @@ static Property sifive_gpio_properties[] = {
     DEFINE_PROP_END_OF_LIST(),
 };
 
+#ifdef CONFIG_FEAR5
+static void sifive_gpio_restore(DeviceState *dev)
+{
+    update_state(SIFIVE_GPIO(dev));
+}
+#endif
+
 static void sifive_gpio_realize(DeviceState *dev, Error **errp)
 {
     SIFIVEGPIOState *s = SIFIVE_GPIO(dev);
@@ -369,6 +379,11 @@ static void sifive_gpio_realize(DeviceState *dev, Error **errp)
 
     qdev_init_gpio_in(DEVICE(s), sifive_gpio_set, s->ngpio);
     qdev_init_gpio_out(DEVICE(s), s->output, s->ngpio);
+
+#ifdef CONFIG_FEAR5
+    fear5_devsnap_register(dev, FEAR5_DEVSNAP_RANGE(s, value, in_mask),
+                           sifive_gpio_restore);
+#endif
 }
 
 static void sifive_gpio_class_init(ObjectClass *klass, void *data)
@@ -32,6 +32,9 @@
 #include "hw/intc/riscv_aclint.h"
 #include "qemu/timer.h"
 #include "hw/irq.h"
+#ifdef CONFIG_FEAR5
+#include "fear5/devsnap.h"
+#endif
 
 typedef struct riscv_aclint_mtimer_callback {
     RISCVAclintMTimerState *s;
@@ -238,6 +241,11 @@ static void riscv_aclint_mtimer_realize(DeviceState *dev, Error **errp)
     s->timer_irqs = g_malloc(sizeof(qemu_irq) * s->num_harts);
     qdev_init_gpio_out(dev, s->timer_irqs, s->num_harts);
 
+#ifdef CONFIG_FEAR5
+    fear5_devsnap_register(dev, FEAR5_DEVSNAP_RANGE(s, hartid_base,
+                                                    timebase_freq), NULL);
+#endif
+
     /* Claim timer interrupt bits */
     for (i = 0; i < s->num_harts; i++) {
         RISCVCPU *cpu = RISCV_CPU(qemu_get_cpu(s->hartid_base + i));
@@ -427,6 +435,11 @@ static void riscv_aclint_swi_realize(DeviceState *dev, Error **errp)
     swi->soft_irqs = g_malloc(sizeof(qemu_irq) * swi->num_harts);
     qdev_init_gpio_out(dev, swi->soft_irqs, swi->num_harts);
 
+#ifdef CONFIG_FEAR5
+    fear5_devsnap_register(dev, FEAR5_DEVSNAP_RANGE(swi, hartid_base, sswi),
+                           NULL);
+#endif
+
     /* Claim software interrupt bits */
     for (i = 0; i < swi->num_harts; i++) {
         RISCVCPU *cpu = RISCV_CPU(qemu_get_cpu(swi->hartid_base + i));
@@ -28,6 +28,9 @@
 #include "hw/qdev-properties.h"
 #include "hw/intc/sifive_plic.h"
 #include "target/riscv/cpu.h"
+#ifdef CONFIG_FEAR5
+#include "fear5/devsnap.h"
+#endif
 #include "migration/vmstate.h"
 #include "hw/irq.h"
 #include "sysemu/kvm.h"
@@ -344,6 +347,13 @@ static void sifive_plic_irq_request(void *opaque, int irq, int level)
     sifive_plic_update(s);
 }
 
+#ifdef CONFIG_FEAR5
+static void sifive_plic_restore(DeviceState *dev)
+{
+    sifive_plic_update(SIFIVE_PLIC(dev));
+}
+#endif
+
 static void sifive_plic_realize(DeviceState *dev, Error **errp)
 {
     SiFivePLICState *s = SIFIVE_PLIC(dev);
@@ -363,6 +373,20 @@ static void sifive_plic_realize(DeviceState *dev, Error **errp)
     s->claimed = g_new0(uint32_t, s->bitfield_words);
     s->enable = g_new0(uint32_t, s->num_enables);
 
+#ifdef CONFIG_FEAR5
+    fear5_devsnap_register(dev, s->source_priority,
+                           sizeof(uint32_t) * s->num_sources, NULL);
+    fear5_devsnap_register(dev, s->target_priority,
+                           sizeof(uint32_t) * s->num_addrs, NULL);
+    fear5_devsnap_register(dev, s->pending,
+                           sizeof(uint32_t) * s->bitfield_words, NULL);
+    fear5_devsnap_register(dev, s->claimed,
+                           sizeof(uint32_t) * s->bitfield_words, NULL);
+    fear5_devsnap_register(dev, s->enable,
+                           sizeof(uint32_t) * s->num_enables,
+                           sifive_plic_restore);
+#endif
+
     qdev_init_gpio_in(dev, sifive_plic_irq_request, s->num_sources);
 
     s->s_external_irqs = g_malloc(sizeof(qemu_irq) * s->num_harts);
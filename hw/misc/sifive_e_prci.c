@@ -24,6 +24,9 @@
 #include "qemu/log.h"
 #include "qemu/module.h"
 #include "hw/misc/sifive_e_prci.h"
+#ifdef CONFIG_FEAR5
+#include "fear5/devsnap.h"
+#endif
 
 static uint64_t sifive_e_prci_read(void *opaque, hwaddr addr, unsigned int size)
 {
@@ -145,9 +148,12 @@ DeviceState *sifive_e_prci_create(hwaddr addr)
     sysbus_mmio_map(SYS_BUS_DEVICE(dev), 0, addr);
 
 #ifdef CONFIG_FEAR5
+    SiFiveEPRCIState *s = SIFIVE_E_PRCI(dev);
+    fear5_devsnap_register(dev, FEAR5_DEVSNAP_RANGE(s, hfrosccfg, plloutdiv),
+                           NULL);
+
     /* Output initial values */
     /*
-    SiFiveEPRCIState *s = SIFIVE_E_PRCI(dev);
     printf("s->hfrosccfg = %u;\n", s->hfrosccfg);
     printf("s->hfxosccfg = %u;\n", s->hfxosccfg);
     printf("s->pllcfg = %u;\n", s->pllcfg);
@@ -23,9 +23,14 @@
 #include "qapi/error.h"
 #include "exec/address-spaces.h"
 #include "exec/ram_addr.h"
+#include "fear5/devsnap.h"
 #include "fear5/faultinjection.h"
 #include "fear5/logger.h"
 #include "fear5/parser.h"
+#include "fear5/sampling.h"
+#include "fear5/stats.h"
+#include "fear5/taint.h"
+#include "fear5/trace.h"
 
 static QEMUTimer *timer = NULL;
 static int64_t tStart;
@@ -117,6 +122,13 @@ static const MemoryRegionOps terminator_ops = {
     }
 };
 
+static void terminator_reset_exit(Object *obj);
+
+static void terminator_restore(DeviceState *dev)
+{
+    terminator_reset_exit(OBJECT(dev));
+}
+
 static void terminator_realize(DeviceState *dev, Error **errp)
 {
     Terminator *d = TERMINATOR(dev);
@@ -128,6 +140,9 @@ static void terminator_realize(DeviceState *dev, Error **errp)
     // fi_log_header();
     timer = timer_new_us(QEMU_CLOCK_VIRTUAL, timeout, NULL);
     // f5_mutex_init();
+
+    // No state of its own, but a fast reset has to end the run as well
+    fear5_devsnap_register(dev, NULL, 0, terminator_restore);
 }
 
 static void terminator_reset_enter(Object *obj, ResetType type)
@@ -147,6 +162,7 @@ static void terminator_reset_exit(Object *obj)
     // Ignore early reset...
     if (f5->phase == PRE_INIT) {
         f5->phase = GOLDEN_RUN;
+        fear5_exec_trace_begin();
         return;
     }
 
@@ -168,6 +184,7 @@ static void terminator_reset_exit(Object *obj)
     if (f5->phase == GOLDEN_RUN) {
         runTimeMax = (f5_get_timeout_factor() * runTime) + f5_get_timeout_us_extra();
         fi_log_goldenrun(runTime, runTimeMax);
+        fear5_stats_campaign_start();
         f5->phase = MUTANT;
         // Exit, if this Golden Run is not followed by any mutants:
         if (FEAR5_COUNT == 0) {
@@ -175,11 +192,15 @@ static void terminator_reset_exit(Object *obj)
         }
     } else if (f5->phase == MUTANT) {
         fi_log_mutant(runTime, runTimeMax, f5->next_code);
+        fear5_stats_mutant_done(runTime, f5->next_code);
+        fear5_sampling_record(f5->next_code);
     }
+    fear5_exec_trace_end();
 
     // Clear state
     memset(f5->gpr, 0, 32*sizeof(Fear5ReadWriteCounter));
     memset(f5->csr, 0, 4096*sizeof(Fear5ReadWriteCounter));
+    f5->dmem_access = 0;
     // f5_mutex_lock();
     g_hash_table_remove_all(f5->mem8);
     g_hash_table_remove_all(f5->mem16);
@@ -202,6 +223,7 @@ static void terminator_reset_exit(Object *obj)
         for (int i = 0; i < g_list_length(values); i++) {
             MemStimulator *s = g_list_nth_data(values, i);
             s->pos = 0;
+            fseek(s->file, 0, SEEK_SET);
         }
     }
 
@@ -215,9 +237,11 @@ static void terminator_reset_exit(Object *obj)
     CPUState *cpu;
     CPU_FOREACH(cpu) {
 
-        // Open question: should the TB flush be done here or better during
-        //                the reset of the terminator device?
-        tb_flush(cpu);
+        // Golden run statistics are collected during translation, so they
+        // still need a fresh code cache for every run.
+        if (qemu_loglevel_mask(FEAR5_LOG_GOLDENRUN)) {
+            tb_flush(cpu);
+        }
         // Same here: should we update the phase here or during QOM reset?
         // f5->phase = MUTANT;
     }
@@ -231,13 +255,42 @@ static void terminator_reset_exit(Object *obj)
     //     }
     // }
 
+    // Apply pending QMP requests (fear5-skip-to, fear5-pause)...
+    fear5_stats_select_next();
+
     // Try to select the next mutant...
-    if (!FEAR5_COUNT || fear5_gotonext_mutant()) {
+    int done = !FEAR5_COUNT || fear5_gotonext_mutant();
+
+    // ...but don't run those the golden run never reaches
+    while (!done && fear5_mutant_unreachable(FEAR5_CURRENT)) {
+        fi_log_mutant(0, runTimeMax, UNREACHABLE);
+        fear5_stats_mutant_done(0, UNREACHABLE);
+        fear5_sampling_record(UNREACHABLE);
+        done = fear5_gotonext_mutant();
+    }
+
+    if (done) {
         // Quit QEMU if no further mutants available
         fi_log_footer();
         exit(0);
     }
 
+    // Translations are kept across mutants and selected by fault key,
+    // but chained TBs must not bypass the lookup for the new mutant...
+    fear5_update_tb_key();
+    tb_unlink_all(first_cpu);
+
+    // DMEM faults are attached to TLB entries, so drop the stale ones...
+    CPU_FOREACH(cpu) {
+        tlb_flush(cpu);
+    }
+
+    // Each mutant records its own execution trace (if enabled)
+    fear5_exec_trace_begin();
+
+    fear5_stats_mutant_started();
+    fear5_taint_begin();
+
     // m = FEAR5_CURRENT;
     // if (m) {
     //     // Minimal TB Invalidation: reset, what is about to be mutated by NEXT mutant
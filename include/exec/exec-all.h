@@ -560,6 +560,31 @@ struct TranslationBlock {
     uintptr_t jmp_list_head;
     uintptr_t jmp_list_next[2];
     uintptr_t jmp_dest[2];
+
+    /*
+     * Tiered translation, see tb_hot_threshold.  TB_TIER_COUNT blocks count
+     * their executions in exec_count and are translated again as a
+     * superblock once they are hot.
+     */
+    uint8_t tier;
+#define TB_TIER_NONE        0
+#define TB_TIER_COUNT       1
+#define TB_TIER_SUPERBLOCK  2
+    /* Translated ahead by the helper thread and not looked up yet */
+    bool prefetched;
+    uint32_t exec_count;
+
+    /*
+     * Value of tb_ctx.tb_evict_count when the TB was last looked up.  Code
+     * regions whose TBs have not been looked up for the longest time are
+     * recycled first, see tb_evict().
+     */
+    uint32_t lookup_epoch;
+
+#ifdef CONFIG_FEAR5
+    /* GPRs accessed through FEAR5 fault hooks, see fear5_tb_affected() */
+    uint32_t f5_gpr_mask;
+#endif
 };
 
 /* Hide the qatomic_read to make code a little easier on the eyes */
@@ -579,7 +604,16 @@ void tb_invalidate_phys_range(target_ulong start, target_ulong end);
 void tb_invalidate_phys_addr(AddressSpace *as, hwaddr addr, MemTxAttrs attrs);
 #endif
 void tb_flush(CPUState *cpu);
+void tb_evict(CPUState *cpu);
+void tb_ras_report(void);
+#ifdef CONFIG_FEAR5
+void tb_unlink_all(CPUState *cpu);
+unsigned tb_get_flush_count(void);
+#endif
 void tb_phys_invalidate(TranslationBlock *tb, tb_page_addr_t page_addr);
+/* Executions after which a TB is translated as a superblock, 0 = never */
+extern uint32_t tb_hot_threshold;
+void tb_mark_hot(TranslationBlock *tb);
 TranslationBlock *tb_htable_lookup(CPUState *cpu, target_ulong pc,
                                    target_ulong cs_base, uint32_t flags,
                                    uint32_t cflags);
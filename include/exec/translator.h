@@ -64,6 +64,9 @@ typedef enum DisasJumpType {
  * @num_insns: Number of translated instructions (including current).
  * @max_insns: Maximum number of instructions to be translated in this TB.
  * @singlestep_enabled: "Hardware" single stepping enabled.
+ * @superblock: Translation may continue across direct branches.
+ * @succ: Destinations of the goto_tb exits, see translator_use_goto_tb().
+ * @num_succ: Number of valid entries in @succ.
  *
  * Architecture-agnostic disassembly context.
  */
@@ -75,6 +78,9 @@ typedef struct DisasContextBase {
     int num_insns;
     int max_insns;
     bool singlestep_enabled;
+    bool superblock;
+    target_ulong succ[2];
+    int num_succ;
 #ifdef CONFIG_USER_ONLY
     /*
      * Guest address of the last byte of the last protected page.
@@ -152,10 +158,59 @@ void translator_loop_temp_check(DisasContextBase *db);
  * @dest: target pc of the goto
  *
  * Return true if goto_tb is allowed between the current TB
- * and the destination PC.
+ * and the destination PC.  The destination is then also recorded
+ * as a successor of the TB in @db->succ.
  */
 bool translator_use_goto_tb(DisasContextBase *db, target_ulong dest);
 
+/**
+ * translator_sb_follow
+ * @db: Disassembly context
+ * @dest: target pc of a direct branch
+ *
+ * Return true if a superblock may go on translating at @dest instead
+ * of ending the TB with a jump there.  Only forward branches within the
+ * page of the TB are followed.
+ */
+bool translator_sb_follow(DisasContextBase *db, target_ulong dest);
+
+/**
+ * translator_exec_count
+ * @db: Disassembly context
+ * @cpu: CPU the TB is translated for
+ * @pc: guest pc on the page of the current TB
+ *
+ * Return how often the TB at @pc was executed so far, or 0 if there is
+ * none.  Superblocks use this to pick the hot successor of a branch.
+ */
+uint32_t translator_exec_count(DisasContextBase *db, CPUState *cpu,
+                               target_ulong pc);
+
+/**
+ * translator_ras_push
+ * @db: Disassembly context
+ * @link: guest pc the call returns to
+ *
+ * Emit code that pushes @link on the return address stack of the vCPU.
+ * To be used by instructions that write the return address of a call.
+ */
+void translator_ras_push(DisasContextBase *db, target_ulong link);
+
+/**
+ * translator_ras_return
+ * @db: Disassembly context
+ * @dest: guest pc of the return, already written to the CPU state
+ * @flags: TB flags at the end of the current TB
+ *
+ * Like tcg_gen_lookup_and_goto_ptr(), but for a return matching a
+ * translator_ras_push().  @dest is checked against the pushed return
+ * address, and the TB returned to last time at this call depth against
+ * @dest, @flags, the cs_base and cflags of the current TB and the trace
+ * state of the vCPU, all inline.  Only a mismatch calls out to look up
+ * the TB, which is then predicted the next time.
+ */
+void translator_ras_return(DisasContextBase *db, TCGv dest, uint32_t flags);
+
 /*
  * Translator Load Functions
  *
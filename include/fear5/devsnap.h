@@ -0,0 +1,38 @@
+/* This is the header for the FEAR5 fast device reset
+   (c) 2022 Paderborn University
+   SPDX-License-Identifier: GPL-2.0-or-later */
+
+#ifndef FI_DEVSNAP_H_
+#define FI_DEVSNAP_H_
+
+#include <stdbool.h>
+#include <stddef.h>
+#include "qemu/typedefs.h"
+
+typedef void (*Fear5DevRestoreFn)(DeviceState *dev);
+
+/*
+ * Devices register the plain data parts of their state, which are saved
+ * right after the first system reset.  Between two mutants, these images
+ * are restored instead of walking the qdev reset tree; the other reset
+ * handlers (RAM, CPUs) run as usual.  The restore function (if any) is
+ * called afterwards to bring IRQ lines etc. in line with the restored
+ * state.
+ *
+ * Every device, except CPUs, with migration state (vmsd) or a reset
+ * method has to be registered, and the machine must not have its own
+ * reset hook.  Otherwise the full reset is used for the whole campaign.
+ */
+void fear5_devsnap_register(DeviceState *dev, void *state, size_t size,
+                            Fear5DevRestoreFn restore);
+void fear5_devsnap_capture(void);
+void fear5_fast_reset_enable(bool on);
+bool fear5_fast_reset(void);
+
+/* state, size arguments for the fields first..last of the struct at s */
+#define FEAR5_DEVSNAP_RANGE(s, first, last)                             \
+    &(s)->first,                                                        \
+    (offsetof(typeof(*(s)), last) + sizeof((s)->last) -                 \
+     offsetof(typeof(*(s)), first))
+
+#endif
@@ -0,0 +1,59 @@
+/* This is the header for distributed FEAR5 campaigns
+   (c) 2022 Paderborn University
+   SPDX-License-Identifier: GPL-2.0-or-later */
+
+#ifndef FI_DIST_H_
+#define FI_DIST_H_
+
+#include <inttypes.h>
+#include <stdbool.h>
+
+/*
+ * A coordinator (-mutant-coordinator) hands out ranges of mutant indices
+ * to any number of workers (-mutant-worker) over a Unix or TCP socket.
+ * Coordinator and workers load the same mutant list.  Every worker does
+ * its own golden run and sends one result record per mutant, from which
+ * the coordinator writes the test report.  If a worker goes away, the
+ * part of its range without results is handed out again.
+ *
+ * All messages are a Fear5DistMsg in big endian byte order:
+ *
+ *   worker -> coordinator
+ *     HELLO    first = number of mutants, golden run time and time_max
+ *     REQUEST  ask for the next range
+ *     RESULT   first = mutant index, code and time
+ *
+ *   coordinator -> worker
+ *     RANGE    mutants first..last-1
+ *     DONE     no more mutants
+ */
+enum Fear5DistMsgType {
+    F5_DIST_HELLO   = 1,
+    F5_DIST_REQUEST = 2,
+    F5_DIST_RESULT  = 3,
+    F5_DIST_RANGE   = 4,
+    F5_DIST_DONE    = 5,
+};
+
+typedef struct Fear5DistMsg {
+    uint32_t type;
+    uint32_t first;
+    uint32_t last;
+    uint32_t code;
+    uint64_t time;
+    uint64_t time_max;
+} Fear5DistMsg;
+
+#define F5_DIST_CHUNK 32
+
+void fear5_dist_set_coordinator(const char *address);
+bool fear5_dist_coordinator_enabled(void);
+void fear5_dist_coordinate(void);
+
+void fear5_dist_worker(const char *address);
+bool fear5_dist_worker_enabled(void);
+int fear5_dist_next(void);
+void fear5_dist_goldenrun(uint64_t time, uint64_t time_max);
+void fear5_dist_result(uint64_t time, uint32_t code);
+
+#endif
@@ -39,7 +39,9 @@ typedef struct Fear5State {
     GHashTable *mem16;
     GHashTable *mem32;
     GHashTable *tb;
+    uint64_t dmem_access;
     uint32_t next_code;
+    uint32_t tb_key;
 } Fear5State;
 
 enum MutantType {
@@ -50,6 +52,7 @@ enum MutantType {
     IMEM_PERMANENT = 5,
     IFR_PERMANENT = 7,
     DMEM_PERMANENT = 8,
+    DMEM_TRANSIENT = 9,
     GPR_STUCK_AT_ZERO  = 10,
     GPR_STUCK_AT_ONE   = 11,
     CSR_STUCK_AT_ZERO  = 30,
@@ -105,6 +108,7 @@ enum MutantResult {
     // INTERRUPT          = 0x500000,
     // MISSING_EXT        = 0x600000,
     EXIT_FAIL          = 0x00000007,
+    UNREACHABLE        = 0x00000008,
     // EXIT_TRAP          = 0x10000000,
 };
 
@@ -118,10 +122,18 @@ extern TestSetup *setup;
 
 MemMonitor* fear5_get_monitor(uint64_t address);
 MemStimulator* fear5_get_stimulator(uint64_t address);
+bool fear5_io_overlaps(uint64_t address, uint64_t size);
+bool fear5_dmem_active(void);
+bool fear5_dmem_page_matches(target_ulong vaddr_page);
+uint64_t fear5_mutate_memop(target_ulong addr, uint64_t val, MemOp op);
+void fear5_update_tb_key(void);
+bool fear5_tb_affected(target_ulong pc, target_ulong size, uint32_t gpr_mask);
+bool fear5_insn_fault_active(void);
 void fear5_init(void);
 void fi_reset_state(void);
 void fear5_kill_mutant(uint32_t code);
 void fear5_printtime(const char* prefix);
+void fear5_log_golden_stats(void);
 
 float f5_get_timeout_factor(void);
 uint64_t f5_get_timeout_us_extra(void);
@@ -4,9 +4,15 @@
 #ifndef FI_PARSER_H_
 #define FI_PARSER_H_
 
+#include "fear5/faultinjection.h"
+
 int testsetup_load(const char *filename);
 int mutantlist_load(const char *filename);
 int fear5_gotonext_mutant(void);
+int fear5_goto_mutant(int index);
+int fear5_mutant_kind(int index);
+int golden_profile_load(const char *filename);
+bool fear5_mutant_unreachable(Mutant *m);
 void mutantlist_close(void);
 
 #endif
\ No newline at end of file
@@ -0,0 +1,14 @@
+/* This is the header for the FEAR5 RAM snapshot (dirty-tracked reset)
+   (c) 2022 Paderborn University
+   SPDX-License-Identifier: GPL-2.0-or-later */
+
+#ifndef FI_RAMSNAP_H_
+#define FI_RAMSNAP_H_
+
+#include <stdbool.h>
+
+void fear5_ram_snapshot(void);
+bool fear5_ram_restore(void);
+void fear5_ram_patch_imem(void);
+
+#endif
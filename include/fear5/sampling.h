@@ -0,0 +1,19 @@
+/* This is the header for FEAR5 statistical fault sampling
+   (c) 2022 Paderborn University
+   SPDX-License-Identifier: GPL-2.0-or-later */
+
+#ifndef FI_SAMPLING_H_
+#define FI_SAMPLING_H_
+
+#include <inttypes.h>
+#include <stdbool.h>
+#include <stdio.h>
+
+void fear5_sampling_configure(const char *optarg);
+bool fear5_sampling_enabled(void);
+int fear5_sampling_next(void);
+int fear5_sampling_count(void);
+void fear5_sampling_record(uint32_t code);
+void fear5_sampling_log(FILE *f);
+
+#endif
@@ -0,0 +1,56 @@
+/* This is the header for the FEAR5 campaign statistics
+   (c) 2022 Paderborn University
+   SPDX-License-Identifier: GPL-2.0-or-later */
+
+#ifndef FI_STATS_H_
+#define FI_STATS_H_
+
+#include <inttypes.h>
+#include <stdbool.h>
+#include <stdio.h>
+
+enum Fear5ResultClass {
+    RESULT_NOT_KILLED,
+    RESULT_SIGNATURE,
+    RESULT_TIMEOUT,
+    RESULT_EXCEPTION,
+    RESULT_EXIT_FAIL,
+    RESULT_UNREACHABLE,
+    RESULT__MAX,
+};
+
+extern const char *fear5_result_class_text[RESULT__MAX];
+
+/*
+ * Host-side cost of a single run (-mutant-costs).  Instructions are
+ * counted per TB entered, so runs ending in an exception in the middle
+ * of a TB are slightly overestimated.
+ */
+typedef struct Fear5MutantCost {
+    uint64_t insns;     // guest instructions executed
+    uint64_t tbs;       // TBs translated
+    uint64_t flushes;   // TB cache flushes
+    uint64_t cpu_ns;    // host CPU time of the run
+    uint64_t reset_ns;  // host time of the reset before the run
+} Fear5MutantCost;
+
+// Updated by translated code and the translator
+extern uintptr_t fear5_cost_insns;
+extern uint64_t fear5_cost_tbs;
+
+enum Fear5ResultClass fear5_result_class(uint32_t code);
+void fear5_stats_campaign_start(void);
+void fear5_stats_mutant_killed(void);
+void fear5_stats_mutant_done(uint64_t time, uint32_t code);
+void fear5_stats_mutant_started(void);
+void fear5_stats_select_next(void);
+void fear5_stats_log(FILE *f);
+
+void fear5_cost_enable(void);
+bool fear5_cost_enabled(void);
+void fear5_cost_end(void);
+void fear5_cost_get(Fear5MutantCost *c);
+void fear5_cost_set(const Fear5MutantCost *c);
+void fear5_cost_log(FILE *f);
+
+#endif
@@ -0,0 +1,63 @@
+/* This is the header for FEAR5 fault-effect (taint) tracking
+   (c) 2022 Paderborn University
+   SPDX-License-Identifier: GPL-2.0-or-later */
+
+#ifndef FI_TAINT_H_
+#define FI_TAINT_H_
+
+#include <inttypes.h>
+#include <stdbool.h>
+#include <stdio.h>
+#include "qemu/typedefs.h"
+
+/*
+ * With -mutant-taint, every GPR, CSR and guest memory page has a shadow
+ * taint flag.  Fault injection taints the faulty location, and inline TCG
+ * ops emitted by the translator propagate it along data flow:
+ *
+ *   rd            <- any source GPR | loaded page | CSR read
+ *   memory page   |= address and data GPRs of a store
+ *   CSR           |= source GPR of a CSR write
+ *
+ * Control flow (e.g. a tainted branch condition) does not taint anything.
+ * Pages are tracked for the low 4 GiB of the address space; higher
+ * addresses alias.  FP and vector registers are not tracked.
+ *
+ * The translator accesses this state directly, so everything is kept in
+ * flat arrays at fixed host addresses.
+ */
+#define F5_TAINT_PAGE_BITS  12
+#define F5_TAINT_PAGES      (1 << (32 - F5_TAINT_PAGE_BITS))
+
+typedef struct Fear5TaintState {
+    uint32_t gpr;                   // bit n set: xn is tainted
+    uint8_t st;                     // taint of the data of the current store
+    uint8_t csr_read;               // CSR helper returned a faulty value
+    uint8_t csr[4096];
+    uint8_t mem[F5_TAINT_PAGES];
+} Fear5TaintState;
+
+// What the report shows for a mutant
+typedef struct Fear5TaintSummary {
+    uint32_t valid;
+    uint32_t gpr;
+    uint32_t csrs;                  // number of tainted CSRs
+    uint32_t pages;                 // number of tainted pages
+    uint32_t stored;                // a tainted value reached a monitor
+    uint64_t store_addr;
+    uint64_t store_pc;
+} Fear5TaintSummary;
+
+extern Fear5TaintState fear5_taint;
+
+void fear5_taint_enable(void);
+bool fear5_taint_enabled(void);
+void fear5_taint_begin(void);
+void fear5_taint_end(void);
+void fear5_taint_mem(uint64_t addr);
+void fear5_taint_monitor_store(CPUState *cs, uint64_t addr, uintptr_t retaddr);
+void fear5_taint_set(const Fear5TaintSummary *s);
+void fear5_taint_get(Fear5TaintSummary *s);
+void fear5_taint_log(FILE *f);
+
+#endif
@@ -0,0 +1,40 @@
+/* This is the header for the compressed FEAR5 execution trace
+   (c) 2022 Paderborn University
+   SPDX-License-Identifier: GPL-2.0-or-later */
+
+#ifndef FI_TRACE_H_
+#define FI_TRACE_H_
+
+#include <inttypes.h>
+#include <stdbool.h>
+
+/*
+ * Trace file layout (all multi-byte fields little endian):
+ *
+ *   "F5TRACE1"                      magic
+ *   record stream                   see below
+ *   index[n] = { u64 record, u64 offset }
+ *   u64 n, u64 index offset
+ *   "F5TRIDX1"                      index magic
+ *
+ * Each record is a varint.  Bit 0 selects the record type:
+ *   0: TB executed, bits 63..1 = zigzag(pc - previous pc)
+ *   1: GPR written, bits 5..1 = register, followed by a varint holding
+ *      zigzag(value - previous value of that register)
+ *
+ * The delta state is reset every F5_TRACE_BLOCK records, where an index
+ * entry is emitted.  Each block can therefore be decoded on its own, and
+ * two runs can be compared block by block without decoding.
+ */
+#define F5_TRACE_MAGIC      "F5TRACE1"
+#define F5_TRACE_IDX_MAGIC  "F5TRIDX1"
+#define F5_TRACE_BLOCK      4096
+
+void fear5_exec_trace_set_path(const char *path);
+bool fear5_exec_trace_enabled(void);
+void fear5_exec_trace_begin(void);
+void fear5_exec_trace_end(void);
+void fear5_exec_trace_pc(uint64_t pc);
+void fear5_exec_trace_gpr(unsigned idx, uint64_t val);
+
+#endif
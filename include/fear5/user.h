@@ -0,0 +1,26 @@
+/* This is the header for FEAR5 mutation testing in linux-user mode
+   (c) 2022 Paderborn University
+   SPDX-License-Identifier: GPL-2.0-or-later */
+
+#ifndef FI_USER_H_
+#define FI_USER_H_
+
+#include "fear5/faultinjection.h"
+
+/*
+ * The guest runs normally until it reaches the entry point (default:
+ * "main").  From there on the process acts as a fork server: the golden
+ * run and every mutant run in a child process forked at that point, so
+ * that the dynamic loader and libc start-up are only simulated once.
+ *
+ * A mutant is killed if it is terminated by a signal, runs into the
+ * timeout, exits with another status than the golden run or writes
+ * anything else to stdout.
+ */
+void fear5_user_set_entry(const char *entry);
+void fear5_user_start(CPUArchState *env);
+bool fear5_user_entry_reached(CPUArchState *env);
+void fear5_user_kill(uint32_t code);
+void fear5_user_exit(void);
+
+#endif
@@ -226,6 +226,13 @@ struct hvf_vcpu_state;
 #define TB_JMP_CACHE_BITS 12
 #define TB_JMP_CACHE_SIZE (1 << TB_JMP_CACHE_BITS)
 
+#define TB_RAS_SIZE 16  /* power of 2 */
+
+typedef struct CPUTBRasEntry {
+    vaddr ret_pc;          /* return address pushed by the call */
+    TranslationBlock *tb;  /* TB last returned to at this depth */
+} CPUTBRasEntry;
+
 /* work queue */
 
 /* The union type allows passing of 64 bit target pointers on 32 bit
@@ -356,6 +363,17 @@ struct CPUState {
 
     /* Accessed in parallel; all accesses must be atomic */
     TranslationBlock *tb_jmp_cache[TB_JMP_CACHE_SIZE];
+    /*
+     * Return address stack, see translator_ras_return().  The tb fields
+     * are accessed in parallel like tb_jmp_cache, everything else only
+     * by the vCPU.  The counters classify the returns: predicted, return
+     * address other than the pushed one, and no valid TB for it.
+     */
+    CPUTBRasEntry tb_ras[TB_RAS_SIZE];
+    uint32_t tb_ras_top;
+    uint64_t tb_ras_hits;
+    uint64_t tb_ras_mispredicts;
+    uint64_t tb_ras_misses;
 
     struct GDBRegisterState *gdb_regs;
     int gdb_num_regs;
@@ -435,6 +453,15 @@ extern CPUTailQ cpus;
 
 extern __thread CPUState *current_cpu;
 
+static inline void cpu_tb_ras_clear(CPUState *cpu)
+{
+    unsigned int i;
+
+    for (i = 0; i < TB_RAS_SIZE; i++) {
+        qatomic_set(&cpu->tb_ras[i].tb, NULL);
+    }
+}
+
 static inline void cpu_tb_jmp_cache_clear(CPUState *cpu)
 {
     unsigned int i;
@@ -442,6 +469,7 @@ static inline void cpu_tb_jmp_cache_clear(CPUState *cpu)
     for (i = 0; i < TB_JMP_CACHE_SIZE; i++) {
         qatomic_set(&cpu->tb_jmp_cache[i], NULL);
     }
+    cpu_tb_ras_clear(cpu);
 }
 
 /**
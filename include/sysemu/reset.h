@@ -6,5 +6,6 @@ typedef void QEMUResetHandler(void *opaque);
 void qemu_register_reset(QEMUResetHandler *func, void *opaque);
 void qemu_unregister_reset(QEMUResetHandler *func, void *opaque);
 void qemu_devices_reset(void);
+void qemu_devices_reset_except(QEMUResetHandler *func, void *opaque);
 
 #endif
@@ -278,6 +278,18 @@ DEF(last_generic, 0, 0, 0, TCG_OPF_NOT_PRESENT)
 /* These opcodes are only for use between the tci generator and interpreter. */
 DEF(tci_movi, 1, 0, 1, TCG_OPF_NOT_PRESENT)
 DEF(tci_movl, 1, 0, 1, TCG_OPF_NOT_PRESENT)
+/* Superinstructions: movi + op, setcond + brcond */
+DEF(tci_addi, 1, 1, 1, TCG_OPF_NOT_PRESENT)
+DEF(tci_andi, 1, 1, 1, TCG_OPF_NOT_PRESENT)
+DEF(tci_ori, 1, 1, 1, TCG_OPF_NOT_PRESENT)
+DEF(tci_xori, 1, 1, 1, TCG_OPF_NOT_PRESENT)
+DEF(tci_shli, 1, 1, 1, TCG_OPF_NOT_PRESENT)
+DEF(tci_shri_i32, 1, 1, 1, TCG_OPF_NOT_PRESENT)
+DEF(tci_sari_i32, 1, 1, 1, TCG_OPF_NOT_PRESENT)
+DEF(tci_shri_i64, 1, 1, 1, TCG_OPF_NOT_PRESENT)
+DEF(tci_sari_i64, 1, 1, 1, TCG_OPF_NOT_PRESENT)
+DEF(tci_brcond_i32, 0, 2, 2, TCG_OPF_NOT_PRESENT)
+DEF(tci_brcond_i64, 0, 2, 2, TCG_OPF_NOT_PRESENT)
 #endif
 
 #undef TLADDR_ARGS
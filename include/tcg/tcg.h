@@ -518,6 +518,8 @@ typedef struct TCGProfile {
     int temp_count_max;
     int64_t temp_count;
     int64_t del_op_count;
+    int64_t cse_count;
+    int64_t dse_count;
     int64_t code_in_len;
     int64_t code_out_len;
     int64_t search_out_len;
@@ -630,6 +632,7 @@ extern __thread TCGContext *tcg_ctx;
 extern const void *tcg_code_gen_epilogue;
 extern uintptr_t tcg_splitwx_diff;
 extern TCGv_env cpu_env;
+extern bool tcg_cse_enabled;
 
 bool in_code_gen_buffer(const void *p);
 
@@ -801,6 +804,8 @@ void tcg_pool_reset(TCGContext *s);
 TranslationBlock *tcg_tb_alloc(TCGContext *s);
 
 void tcg_region_reset_all(void);
+int tcg_region_evict(TCGContext *s, uint32_t epoch, GTraverseFunc func,
+                     GTraverseFunc probe, gpointer data);
 
 size_t tcg_code_size(void);
 size_t tcg_code_capacity(void);
@@ -11,6 +11,7 @@
 #include "loader.h"
 #include "user-mmap.h"
 #include "disas/disas.h"
+#include "accel/tcg/perf.h"
 #include "qemu/bitops.h"
 #include "qemu/path.h"
 #include "qemu/queue.h"
@@ -19,6 +20,9 @@
 #include "qemu/selfmap.h"
 #include "qapi/error.h"
 #include "target_signal.h"
+#ifdef CONFIG_FEAR5
+#include "fear5/faultinjection.h"
+#endif
 
 #ifdef _ARCH_PPC64
 #undef ARCH_DLINFO
@@ -3004,7 +3008,12 @@ static void load_elf_image(const char *image_name, int image_fd,
         info->end_data = info->end_code;
     }
 
-    if (qemu_log_enabled()) {
+    if (qemu_log_enabled() || perf_enabled()
+#ifdef CONFIG_FEAR5
+        /* The mutants are forked at a symbol, see fear5/user.c */
+        || FEAR5_COUNT
+#endif
+        ) {
         load_symbols(ehdr, image_fd, load_bias);
     }
 
@@ -3087,6 +3096,31 @@ static const char *lookup_symbolxx(struct syminfo *s, target_ulong orig_addr)
     return "";
 }
 
+bool elf_lookup_symbol(const char *name, target_ulong *addr)
+{
+    struct syminfo *s;
+
+    for (s = syminfos; s; s = s->next) {
+#if ELF_CLASS == ELFCLASS32
+        struct elf_sym *syms = s->disas_symtab.elf32;
+#else
+        struct elf_sym *syms = s->disas_symtab.elf64;
+#endif
+        unsigned int i;
+
+        if (s->lookup_symbol != lookup_symbolxx) {
+            continue;
+        }
+        for (i = 0; i < s->disas_num_syms; i++) {
+            if (strcmp(s->disas_strtab + syms[i].st_name, name) == 0) {
+                *addr = syms[i].st_value;
+                return true;
+            }
+        }
+    }
+    return false;
+}
+
 /* FIXME: This should use elf_ops.h  */
 static int symcmp(const void *s0, const void *s1)
 {
@@ -20,9 +20,14 @@
 #include "exec/gdbstub.h"
 #include "qemu.h"
 #include "user-internals.h"
+#include "accel/tcg/perf.h"
+#include "accel/tcg/tb-prefetch.h"
 #ifdef CONFIG_GPROF
 #include <sys/gmon.h>
 #endif
+#ifdef CONFIG_FEAR5
+#include "fear5/user.h"
+#endif
 
 #ifdef CONFIG_GCOV
 extern void __gcov_dump(void);
@@ -38,4 +43,10 @@ void preexit_cleanup(CPUArchState *env, int code)
 #endif
         gdb_exit(code);
         qemu_plugin_user_exit();
+        tb_ras_report();
+        tb_prefetch_exit();
+        perf_exit();
+#ifdef CONFIG_FEAR5
+        fear5_user_exit();
+#endif
 }
@@ -54,6 +54,16 @@
 #include "signal-common.h"
 #include "loader.h"
 #include "user-mmap.h"
+#ifdef CONFIG_FEAR5
+#include "fear5/dist.h"
+#include "fear5/logger.h"
+#include "fear5/parser.h"
+#include "fear5/sampling.h"
+#include "fear5/stats.h"
+#include "fear5/taint.h"
+#include "fear5/trace.h"
+#include "fear5/user.h"
+#endif
 
 #ifndef AT_FLAGS_PRESERVE_ARGV0
 #define AT_FLAGS_PRESERVE_ARGV0_BIT 0
@@ -392,6 +402,36 @@ static void handle_arg_trace(const char *arg)
     trace_opt_parse(arg);
 }
 
+static void handle_arg_hot_threshold(const char *arg)
+{
+    object_property_parse(OBJECT(current_accel()), "hot-threshold", arg,
+                          &error_fatal);
+}
+
+static void handle_arg_x_cse(const char *arg)
+{
+    object_property_set_bool(OBJECT(current_accel()), "x-cse", true,
+                             &error_fatal);
+}
+
+static void handle_arg_tb_prefetch(const char *arg)
+{
+    object_property_set_bool(OBJECT(current_accel()), "tb-prefetch", true,
+                             &error_fatal);
+}
+
+static void handle_arg_perfmap(const char *arg)
+{
+    object_property_set_bool(OBJECT(current_accel()), "perf-map", true,
+                             &error_fatal);
+}
+
+static void handle_arg_jitdump(const char *arg)
+{
+    object_property_set_bool(OBJECT(current_accel()), "jitdump", true,
+                             &error_fatal);
+}
+
 #if defined(TARGET_XTENSA)
 static void handle_arg_abi_call0(const char *arg)
 {
@@ -408,6 +448,64 @@ static void handle_arg_plugin(const char *arg)
 }
 #endif
 
+#ifdef CONFIG_FEAR5
+static void handle_arg_mutant_list(const char *arg)
+{
+    if (mutantlist_load(arg)) {
+        error_report("open %s failed!", arg);
+        exit(EXIT_FAILURE);
+    }
+}
+
+static void handle_arg_test_report(const char *arg)
+{
+    fi_set_logfile(arg);
+}
+
+static void handle_arg_test_setup(const char *arg)
+{
+    testsetup_load(arg);
+}
+
+static void handle_arg_golden_profile(const char *arg)
+{
+    if (golden_profile_load(arg)) {
+        error_report("open %s failed!", arg);
+        exit(EXIT_FAILURE);
+    }
+}
+
+static void handle_arg_mutant_sampling(const char *arg)
+{
+    fear5_sampling_configure(arg);
+}
+
+static void handle_arg_mutant_entry(const char *arg)
+{
+    fear5_user_set_entry(arg);
+}
+
+static void handle_arg_exec_trace(const char *arg)
+{
+    fear5_exec_trace_set_path(arg);
+}
+
+static void handle_arg_mutant_worker(const char *arg)
+{
+    fear5_dist_worker(arg);
+}
+
+static void handle_arg_mutant_costs(const char *arg)
+{
+    fear5_cost_enable();
+}
+
+static void handle_arg_mutant_taint(const char *arg)
+{
+    fear5_taint_enable();
+}
+#endif
+
 struct qemu_argument {
     const char *argv;
     const char *env;
@@ -459,12 +557,46 @@ static const struct qemu_argument arg_table[] = {
      "",           "Seed for pseudo-random number generator"},
     {"trace",      "QEMU_TRACE",       true,  handle_arg_trace,
      "",           "[[enable=]<pattern>][,events=<file>][,file=<file>]"},
+    {"hot-threshold", "QEMU_HOT_THRESHOLD", true, handle_arg_hot_threshold,
+     "n",          "translate TBs run 'n' times again as superblocks"},
+    {"x-cse",      "QEMU_X_CSE",       false, handle_arg_x_cse,
+     "",           "debug: eliminate common subexpressions in TCG"},
+    {"tb-prefetch", "QEMU_TB_PREFETCH", false, handle_arg_tb_prefetch,
+     "",           "translate the successors of new TBs in a helper thread"},
+    {"perfmap",    "QEMU_PERFMAP",     false, handle_arg_perfmap,
+     "",           "name translated code for perf in /tmp/perf-<pid>.map"},
+    {"jitdump",    "QEMU_JITDUMP",     false, handle_arg_jitdump,
+     "",           "write translated code for perf to /tmp/jit-<pid>.dump"},
 #ifdef CONFIG_PLUGIN
     {"plugin",     "QEMU_PLUGIN",      true,  handle_arg_plugin,
      "",           "[file=]<file>[,<argname>=<argvalue>]"},
 #endif
     {"version",    "QEMU_VERSION",     false, handle_arg_version,
      "",           "display version information and exit"},
+#ifdef CONFIG_FEAR5
+    {"mutant-list", "QEMU_MUTANT_LIST", true, handle_arg_mutant_list,
+     "file",       "list of mutants to simulate"},
+    {"test-report", "QEMU_TEST_REPORT", true, handle_arg_test_report,
+     "file",       "log test results to 'file'"},
+    {"test-setup", "QEMU_TEST_SETUP",  true,  handle_arg_test_setup,
+     "file",       "mutation test setup (timeout)"},
+    {"golden-profile", "QEMU_GOLDEN_PROFILE", true, handle_arg_golden_profile,
+     "file",       "skip mutants the golden run never reaches"},
+    {"mutant-sampling", "QEMU_MUTANT_SAMPLING", true, handle_arg_mutant_sampling,
+     "",           "[width=]w[,confidence=c][,stratify=on|off][,min=n][,seed=s]"},
+    {"mutant-entry", "QEMU_MUTANT_ENTRY", true, handle_arg_mutant_entry,
+     "symbol",     "fork golden run and mutants at 'symbol' or address "
+     "(default main)"},
+    {"exec-trace", "QEMU_EXEC_TRACE",  true,  handle_arg_exec_trace,
+     "file",       "record compressed PC/register traces"},
+    {"mutant-worker", "QEMU_MUTANT_WORKER", true, handle_arg_mutant_worker,
+     "address",    "simulate the mutants handed out by the coordinator "
+     "at 'address'"},
+    {"mutant-costs", "QEMU_MUTANT_COSTS", false, handle_arg_mutant_costs,
+     "",           "add host-side cost columns to the test report"},
+    {"mutant-taint", "QEMU_MUTANT_TAINT", false, handle_arg_mutant_taint,
+     "",           "report how far the fault of each mutant propagates"},
+#endif
 #if defined(TARGET_XTENSA)
     {"xtensa-abi-call0", "QEMU_XTENSA_ABI_CALL0", false, handle_arg_abi_call0,
      "",           "assume CALL0 Xtensa ABI"},
@@ -872,6 +1004,10 @@ int main(int argc, char **argv, char **envp)
 
     target_cpu_copy_regs(env, regs);
 
+#ifdef CONFIG_FEAR5
+    fear5_user_start(env);
+#endif
+
     if (gdbstub) {
         if (gdbserver_start(gdbstub) < 0) {
             fprintf(stderr, "qemu: could not open gdbserver on %s\n",
@@ -26,6 +26,9 @@
 #include "signal-common.h"
 #include "elf.h"
 #include "semihosting/common-semi.h"
+#ifdef CONFIG_FEAR5
+#include "fear5/user.h"
+#endif
 
 void cpu_loop(CPURISCVState *env)
 {
@@ -78,6 +81,11 @@ void cpu_loop(CPURISCVState *env)
             break;
         case RISCV_EXCP_BREAKPOINT:
         case EXCP_DEBUG:
+#ifdef CONFIG_FEAR5
+            if (trapnr == EXCP_DEBUG && fear5_user_entry_reached(env)) {
+                break;
+            }
+#endif
         gdbstep:
             force_sig_fault(TARGET_SIGTRAP, TARGET_TRAP_BRKPT, env->pc);
             break;
@@ -32,6 +32,9 @@
 #include "signal-common.h"
 #include "host-signal.h"
 #include "user/safe-syscall.h"
+#ifdef CONFIG_FEAR5
+#include "fear5/user.h"
+#endif
 
 static struct target_sigaction sigact_table[TARGET_NSIG];
 
@@ -736,6 +739,9 @@ static void QEMU_NORETURN dump_core_and_abort(int target_sig)
     host_sig = target_to_host_signal(target_sig);
     trace_user_dump_core_and_abort(env, target_sig, host_sig);
     gdb_signalled(env, target_sig);
+#ifdef CONFIG_FEAR5
+    fear5_user_exit();
+#endif
 
     /* dump core if supported by target binary format */
     if (core_dump_signal(target_sig) && (ts->bprm->core_dump != NULL)) {
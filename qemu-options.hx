@@ -151,6 +151,9 @@ DEF("accel", HAS_ARG, QEMU_OPTION_accel,
     "                kvm-shadow-mem=size of KVM shadow MMU in bytes\n"
     "                split-wx=on|off (enable TCG split w^x mapping)\n"
     "                tb-size=n (TCG translation block cache size)\n"
+    "                hot-threshold=n (retranslate TBs run n times as superblocks)\n"
+    "                perf-map=on|off (name TCG translations in /tmp/perf-<pid>.map)\n"
+    "                jitdump=on|off (write TCG translations to /tmp/jit-<pid>.dump)\n"
     "                dirty-ring-size=n (KVM dirty ring GFN count, default 0)\n"
     "                thread=single|multi (enable multi-threaded TCG)\n", QEMU_ARCH_ALL)
 SRST
@@ -185,6 +188,24 @@ SRST
     ``tb-size=n``
         Controls the size (in MiB) of the TCG translation block cache.
 
+    ``hot-threshold=n``
+        Translates a TB that has been executed n times again as a
+        superblock, which continues across direct branches along the
+        more frequently executed path. The default of 0 disables this.
+        Only the RISC-V target forms superblocks.
+
+    ``perf-map=on|off``
+        Writes the host address and size of every TB to
+        ``/tmp/perf-<pid>.map``, named by its guest pc and, if known, the
+        guest symbol, so that ``perf report`` attributes time spent in
+        translated code to guest code. Only available on Linux hosts.
+
+    ``jitdump=on|off``
+        Like ``perf-map``, but writes ``/tmp/jit-<pid>.dump`` in the
+        jitdump format including the translated code. Record with
+        ``perf record -k 1`` and process the result with
+        ``perf inject --jit`` to also annotate translated code.
+
     ``thread=single|multi``
         Controls number of TCG threads. When the TCG is multi-threaded
         there will be one thread per vCPU therefore taking advantage of
@@ -4738,6 +4759,113 @@ SRST
     Mutation test setup file.
 ERST
 
+DEF("golden-profile", HAS_ARG, QEMU_OPTION_goldenprofile,
+    "-golden-profile <file>\n"
+    "                skip mutants the golden run never reaches\n",
+    QEMU_ARCH_RISCV)
+SRST
+``-golden-profile file``
+    Golden run statistics as written with ``-d goldenrun``. Mutants at
+    instructions never executed, memory never accessed, or registers and
+    CSRs never accessed (or accessed fewer times than a transient fault
+    needs) are reported as "not killed (unreachable)" without running them.
+ERST
+
+DEF("mutant-sampling", HAS_ARG, QEMU_OPTION_mutantsampling,
+    "-mutant-sampling [width=]w[,confidence=c][,stratify=on|off][,min=n][,seed=s]\n"
+    "                draw mutants at random until the kill rate is known\n"
+    "                within an interval of width w (default confidence 0.95)\n",
+    QEMU_ARCH_RISCV)
+SRST
+``-mutant-sampling [width=]w[,confidence=c][,stratify=on|off][,min=n][,seed=s]``
+    Estimate the result proportions from a random sample of the mutant
+    list instead of simulating all mutants. Mutants are drawn without
+    replacement, stratified by mutant kind unless ``stratify=off``.
+    Sampling stops after at least ``min`` (default 30) mutants once the
+    ``c`` confidence interval of the kill rate is narrower than ``w``.
+    The estimates are written to the test report footer.
+ERST
+
+DEF("exec-trace", HAS_ARG, QEMU_OPTION_exectrace,
+    "-exec-trace <file>\n"
+    "                record compressed PC/register traces (golden run to <file>,\n"
+    "                mutants to <file>.<id>)\n",
+    QEMU_ARCH_RISCV)
+SRST
+``-exec-trace file``
+    Record a compressed binary trace of executed TBs and register writes.
+    The golden run is written to ``file``, every mutant to ``file.<id>``.
+    Use ``scripts/fear5-trace-diff.py`` to find the first divergence.
+ERST
+
+DEF("mutant-coordinator", HAS_ARG, QEMU_OPTION_mutantcoordinator,
+    "-mutant-coordinator <address>\n"
+    "                hand out mutants to workers connecting to unix:<path>\n"
+    "                or <host>:<port> and write their results to the report\n",
+    QEMU_ARCH_RISCV)
+SRST
+``-mutant-coordinator address``
+    Run as coordinator of a distributed campaign instead of starting a
+    guest. Ranges of the mutant list are handed out to the workers
+    connecting to ``address`` (``unix:path`` or ``host:port``), and the
+    test report is written from their results. Ranges of workers that
+    disconnect before reporting all of their mutants are handed out
+    again.
+ERST
+
+DEF("mutant-worker", HAS_ARG, QEMU_OPTION_mutantworker,
+    "-mutant-worker <address>\n"
+    "                simulate the mutants handed out by the coordinator at <address>\n",
+    QEMU_ARCH_RISCV)
+SRST
+``-mutant-worker address``
+    Do the golden run, then simulate the mutants handed out by the
+    coordinator at ``address``. Workers need the same ``-mutant-list``
+    as the coordinator.
+ERST
+
+DEF("mutant-costs", 0, QEMU_OPTION_mutantcosts,
+    "-mutant-costs   add host-side cost columns (instructions, translations,\n"
+    "                TB flushes, CPU and reset time) to the test report\n",
+    QEMU_ARCH_RISCV)
+SRST
+``-mutant-costs``
+    Record the host-side cost of every mutant run: guest instructions
+    executed, TBs translated, TB cache flushes, host CPU time and the
+    time of the reset before the run. They are written as extra columns
+    of the test report, and the report footer shows the averages per
+    mutant kind. Not available on a ``-mutant-coordinator``.
+ERST
+
+DEF("mutant-reset", HAS_ARG, QEMU_OPTION_mutantreset,
+    "-mutant-reset fast|full\n"
+    "                restore device snapshots between mutants (fast, default)\n"
+    "                or do a full system reset\n",
+    QEMU_ARCH_RISCV)
+SRST
+``-mutant-reset fast|full``
+    Between two mutants, ``fast`` restores device state from snapshots
+    taken after the first system reset instead of resetting every device.
+    The other reset handlers, which restore RAM and reset the CPUs, run as
+    usual. Machines with their own reset hook, or with devices that do not
+    support this, fall back to ``full`` automatically.
+ERST
+
+DEF("mutant-taint", 0, QEMU_OPTION_mutanttaint,
+    "-mutant-taint   track how far the fault of each mutant propagates and\n"
+    "                add the tainted state to the test report\n",
+    QEMU_ARCH_RISCV)
+SRST
+``-mutant-taint``
+    Keep a shadow taint flag for every GPR, CSR and 4 KiB page of guest
+    memory. The fault location of a mutant is tainted when the fault is
+    applied, and translated code propagates the taint along data flow.
+    After each mutant line, the test report lists the tainted GPRs, the
+    number of tainted CSRs and pages, and the first store of a tainted
+    value to a monitored address. Not available on a
+    ``-mutant-coordinator``.
+ERST
+
 DEFHEADING()
 #endif
 
@@ -0,0 +1,120 @@
+#!/usr/bin/env python3
+#
+# Report the first divergence between two FEAR5 execution traces
+# (as written by -exec-trace, see include/fear5/trace.h)
+#
+# Copyright (c) 2022 Paderborn University, DE
+#
+# SPDX-License-Identifier: GPL-2.0-or-later
+#
+# Usage: fear5-trace-diff.py <golden trace> <mutant trace>
+
+import struct
+import sys
+
+TRACE_MAGIC = b'F5TRACE1'
+INDEX_MAGIC = b'F5TRIDX1'
+
+
+class Trace:
+    def __init__(self, path):
+        with open(path, 'rb') as f:
+            self.data = f.read()
+        if self.data[:8] != TRACE_MAGIC or self.data[-8:] != INDEX_MAGIC:
+            raise ValueError('%s: not a FEAR5 trace file' % path)
+        count, index_offset = struct.unpack_from('<QQ', self.data,
+                                                 len(self.data) - 24)
+        self.end = index_offset
+        self.index = [struct.unpack_from('<QQ', self.data, index_offset + 16 * i)
+                      for i in range(count)]
+
+    def block(self, i):
+        '''Return the raw bytes of block i'''
+        start = self.index[i][1]
+        end = self.index[i + 1][1] if i + 1 < len(self.index) else self.end
+        return self.data[start:end]
+
+    def records(self, i):
+        '''Decode block i into (record number, kind, register, value) tuples'''
+        data = self.block(i)
+        nr = self.index[i][0]
+        pos = 0
+        pc = 0
+        gpr = [0] * 32
+        while pos < len(data):
+            v, pos = read_varint(data, pos)
+            if v & 1:
+                reg = (v >> 1) & 0x1f
+                d, pos = read_varint(data, pos)
+                gpr[reg] = (gpr[reg] + unzigzag(d)) & 0xffffffffffffffff
+                yield nr, 'gpr', reg, gpr[reg]
+            else:
+                pc = (pc + unzigzag(v >> 1)) & 0xffffffffffffffff
+                yield nr, 'pc', None, pc
+            nr += 1
+
+
+def read_varint(data, pos):
+    v = 0
+    shift = 0
+    while True:
+        b = data[pos]
+        pos += 1
+        v |= (b & 0x7f) << shift
+        shift += 7
+        if not b & 0x80:
+            return v, pos
+
+
+def unzigzag(v):
+    return (v >> 1) ^ -(v & 1)
+
+
+def fmt(rec):
+    if rec is None:
+        return 'end of trace'
+    nr, kind, reg, val = rec
+    if kind == 'pc':
+        return 'TB   pc=0x%x' % val
+    return 'GPR  x%d=0x%x' % (reg, val)
+
+
+def main(args):
+    if len(args) != 3:
+        sys.stderr.write('usage: %s <golden trace> <mutant trace>\n' % args[0])
+        return 2
+
+    golden = Trace(args[1])
+    mutant = Trace(args[2])
+
+    # Blocks start at the same record numbers in both traces, so identical
+    # blocks can be skipped without decoding them.
+    blocks = max(len(golden.index), len(mutant.index))
+    for i in range(blocks):
+        if i < len(golden.index) and i < len(mutant.index) and \
+           golden.block(i) == mutant.block(i):
+            continue
+
+        g = list(golden.records(i)) if i < len(golden.index) else []
+        m = list(mutant.records(i)) if i < len(mutant.index) else []
+        pc = None
+        for j in range(max(len(g), len(m))):
+            a = g[j] if j < len(g) else None
+            b = m[j] if j < len(m) else None
+            if a != b:
+                nr = (a or b)[0]
+                print('first divergence at record %d (block %d)' % (nr, i))
+                if pc is not None:
+                    print('  last common TB: 0x%x' % pc)
+                print('  golden: %s' % fmt(a))
+                print('  mutant: %s' % fmt(b))
+                return 1
+            if a[1] == 'pc':
+                pc = a[3]
+
+    print('traces are identical')
+    return 0
+
+
+if __name__ == '__main__':
+    sys.exit(main(sys.argv))
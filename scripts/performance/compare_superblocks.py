@@ -0,0 +1,104 @@
+#!/usr/bin/env python3
+
+#  Compare the run time of a guest program with different superblock
+#  thresholds (-accel tcg,hot-threshold=n).
+#  Syntax:
+#  compare_superblocks.py [-h] [-t <thresholds>] [-r <runs>] -- \
+#           <qemu executable> [<qemu executable options>] \
+#           <target executable> [<target executable options>]
+#
+#  [-h] - Print the script arguments help message.
+#  [-t] - Comma separated thresholds to compare, 0 disables superblocks.
+#       - If this flag is not specified, the tool defaults to 0,100.
+#  [-r] - Number of runs per threshold, the fastest one is reported.
+#       - If this flag is not specified, the tool defaults to 3.
+#
+#  The threshold is passed as -hot-threshold to user mode emulators and
+#  as -accel tcg,hot-threshold=n to system emulators.  The output of every
+#  run has to be the same as the output of the first one.
+#
+#  Example of usage:
+#  compare_superblocks.py -t 0,50,1000 -- qemu-riscv32 coremark.riscv32
+#  compare_superblocks.py -- qemu-system-riscv32 -M virt -bios none \
+#           -nographic -kernel dhrystone.elf
+#
+#  This program is free software: you can redistribute it and/or modify
+#  it under the terms of the GNU General Public License as published by
+#  the Free Software Foundation, either version 2 of the License, or
+#  (at your option) any later version.
+#
+#  This program is distributed in the hope that it will be useful,
+#  but WITHOUT ANY WARRANTY; without even the implied warranty of
+#  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+#  GNU General Public License for more details.
+#
+#  You should have received a copy of the GNU General Public License
+#  along with this program. If not, see <https://www.gnu.org/licenses/>.
+
+import argparse
+import os
+import subprocess
+import sys
+import time
+
+
+# Parse the command line arguments
+parser = argparse.ArgumentParser(
+    usage='compare_superblocks.py [-h] [-t <thresholds>] [-r <runs>] -- '
+          '<qemu executable> [<qemu executable options>] '
+          '<target executable> [<target executable options>]')
+
+parser.add_argument('-t', dest='thresholds', type=str, default='0,100',
+                    help='Comma separated thresholds to compare.')
+
+parser.add_argument('-r', dest='runs', type=int, default=3,
+                    help='Number of runs per threshold.')
+
+parser.add_argument('command', type=str, nargs='+', help=argparse.SUPPRESS)
+
+args = parser.parse_args()
+
+# Extract the needed variables from the args
+command = args.command
+thresholds = [int(t) for t in args.thresholds.split(',')]
+runs = max(args.runs, 1)
+
+
+def threshold_command(threshold):
+    """Return the command line that runs with the given threshold."""
+    if 'qemu-system-' in os.path.basename(command[0]):
+        return command + ['-accel', 'tcg,hot-threshold={}'.format(threshold)]
+    return ([command[0], '-hot-threshold', str(threshold)] + command[1:])
+
+
+reference = None
+results = []
+for threshold in thresholds:
+    best = None
+    for _ in range(runs):
+        start = time.monotonic()
+        run = subprocess.run(threshold_command(threshold),
+                             stdout=subprocess.PIPE,
+                             stderr=subprocess.PIPE)
+        elapsed = time.monotonic() - start
+        if run.returncode:
+            sys.exit(run.stderr.decode("utf-8"))
+        if reference is None:
+            reference = run.stdout
+        elif run.stdout != reference:
+            sys.exit("Output with threshold {} differs!".format(threshold))
+        best = elapsed if best is None else min(best, elapsed)
+    results.append((threshold, best))
+
+# Print table header
+print('{:>10}  {:>10}  {:>8}\n{}  {}  {}'.format('Threshold',
+                                               'Time [s]',
+                                               'Speedup',
+                                               '-' * 10,
+                                               '-' * 10,
+                                               '-' * 8))
+
+# Print the run time relative to the first threshold
+for (threshold, elapsed) in results:
+    print('{:>10}  {:>10.3f}  {:>7.2f}x'.format(threshold, elapsed,
+                                                 results[0][1] / elapsed))
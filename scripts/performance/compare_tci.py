@@ -0,0 +1,95 @@
+#!/usr/bin/env python3
+
+#  Compare the run time of a guest program under a QEMU built with the TCG
+#  interpreter (--enable-tcg-interpreter) and one built with native TCG.
+#  Syntax:
+#  compare_tci.py [-h] -i <tci qemu executable> [-r <runs>] -- \
+#           <qemu executable> [<qemu executable options>] \
+#           <target executable> [<target executable options>]
+#
+#  [-h] - Print the script arguments help message.
+#  -i   - The QEMU executable built with the interpreter.  It is run with
+#         the same options as the native one.
+#  [-r] - Number of runs per executable, the fastest one is reported.
+#       - If this flag is not specified, the tool defaults to 3.
+#
+#  The output of the interpreted run has to be the same as the output of
+#  the native one.
+#
+#  Example of usage:
+#  compare_tci.py -i build-tci/qemu-riscv32 -- \
+#           build/qemu-riscv32 coremark.riscv32
+#
+#  This program is free software: you can redistribute it and/or modify
+#  it under the terms of the GNU General Public License as published by
+#  the Free Software Foundation, either version 2 of the License, or
+#  (at your option) any later version.
+#
+#  This program is distributed in the hope that it will be useful,
+#  but WITHOUT ANY WARRANTY; without even the implied warranty of
+#  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+#  GNU General Public License for more details.
+#
+#  You should have received a copy of the GNU General Public License
+#  along with this program. If not, see <https://www.gnu.org/licenses/>.
+
+import argparse
+import subprocess
+import sys
+import time
+
+
+# Parse the command line arguments
+parser = argparse.ArgumentParser(
+    usage='compare_tci.py [-h] -i <tci qemu executable> [-r <runs>] -- '
+          '<qemu executable> [<qemu executable options>] '
+          '<target executable> [<target executable options>]')
+
+parser.add_argument('-i', dest='tci', type=str, required=True,
+                    help='QEMU executable built with the interpreter.')
+
+parser.add_argument('-r', dest='runs', type=int, default=3,
+                    help='Number of runs per executable.')
+
+parser.add_argument('command', type=str, nargs='+', help=argparse.SUPPRESS)
+
+args = parser.parse_args()
+
+# Extract the needed variables from the args
+command = args.command
+runs = max(args.runs, 1)
+
+
+def best_time(cmd):
+    """Return the fastest run time and the output of cmd."""
+    best = None
+    output = None
+    for _ in range(runs):
+        start = time.monotonic()
+        run = subprocess.run(cmd, stdout=subprocess.PIPE,
+                             stderr=subprocess.PIPE)
+        elapsed = time.monotonic() - start
+        if run.returncode:
+            sys.exit(run.stderr.decode("utf-8"))
+        output = run.stdout
+        best = elapsed if best is None else min(best, elapsed)
+    return best, output
+
+
+native, reference = best_time(command)
+tci, output = best_time([args.tci] + command[1:])
+if output != reference:
+    sys.exit("Output of the interpreter differs!")
+
+# Print table header
+print('{:>10}  {:>10}  {:>8}\n{}  {}  {}'.format('TCG',
+                                               'Time [s]',
+                                               'Slowdown',
+                                               '-' * 10,
+                                               '-' * 10,
+                                               '-' * 8))
+
+# Print the run time relative to native TCG
+for (name, elapsed) in (('native', native), ('tci', tci)):
+    print('{:>10}  {:>10.3f}  {:>7.2f}x'.format(name, elapsed,
+                                                 elapsed / native))
@@ -60,6 +60,11 @@
 #include "sysemu/tpm.h"
 #include "trace.h"
 
+#ifdef CONFIG_FEAR5
+#include "fear5/devsnap.h"
+#include "fear5/ramsnap.h"
+#endif
+
 static NotifierList exit_notifiers =
     NOTIFIER_LIST_INITIALIZER(exit_notifiers);
 
@@ -439,11 +444,25 @@ void qemu_system_reset(ShutdownCause reason)
 
     cpu_synchronize_all_states();
 
+#ifdef CONFIG_FEAR5
+    // Between two mutants, restore snapshots instead (see fear5/devsnap.c)
+    if (fear5_fast_reset()) {
+        fear5_ram_patch_imem();
+        cpu_synchronize_all_post_reset();
+        return;
+    }
+#endif
+
     if (mc && mc->reset) {
         mc->reset(current_machine);
     } else {
         qemu_devices_reset();
     }
+#ifdef CONFIG_FEAR5
+    fear5_devsnap_capture();
+    // After rom_reset(), which restores the previous mutant's RAM
+    fear5_ram_patch_imem();
+#endif
     if (reason && reason != SHUTDOWN_CAUSE_SUBSYSTEM_RESET) {
         qapi_event_send_reset(shutdown_caused_by_guest(reason), reason);
     }
@@ -131,8 +131,14 @@
 
 #ifdef CONFIG_FEAR5
 #include "fear5/faultinjection.h"
+#include "fear5/devsnap.h"
+#include "fear5/dist.h"
 #include "fear5/logger.h"
 #include "fear5/parser.h"
+#include "fear5/sampling.h"
+#include "fear5/stats.h"
+#include "fear5/taint.h"
+#include "fear5/trace.h"
 #endif
 
 #define MAX_VIRTIO_CONSOLES 1
@@ -3685,6 +3691,40 @@ void qemu_init(int argc, char **argv, char **envp)
             case QEMU_OPTION_testsetup:
                 testsetup_load(optarg);
                 break;
+            case QEMU_OPTION_goldenprofile:
+                if (golden_profile_load(optarg)) {
+                    error_report("open %s failed!", optarg);
+                    exit(1);
+                }
+                break;
+            case QEMU_OPTION_mutantsampling:
+                fear5_sampling_configure(optarg);
+                break;
+            case QEMU_OPTION_exectrace:
+                fear5_exec_trace_set_path(optarg);
+                break;
+            case QEMU_OPTION_mutantcoordinator:
+                fear5_dist_set_coordinator(optarg);
+                break;
+            case QEMU_OPTION_mutantworker:
+                fear5_dist_worker(optarg);
+                break;
+            case QEMU_OPTION_mutantcosts:
+                fear5_cost_enable();
+                break;
+            case QEMU_OPTION_mutanttaint:
+                fear5_taint_enable();
+                break;
+            case QEMU_OPTION_mutantreset:
+                if (!strcmp(optarg, "fast")) {
+                    fear5_fast_reset_enable(true);
+                } else if (!strcmp(optarg, "full")) {
+                    fear5_fast_reset_enable(false);
+                } else {
+                    error_report("-mutant-reset: expected fast or full");
+                    exit(1);
+                }
+                break;
 #endif                
             default:
                 if (os_parse_cmd_args(popt->index, optarg)) {
@@ -3712,6 +3752,26 @@ void qemu_init(int argc, char **argv, char **envp)
     qemu_process_help_options();
     qemu_maybe_daemonize(pid_file);
 
+#ifdef CONFIG_FEAR5
+    if ((fear5_dist_coordinator_enabled() || fear5_dist_worker_enabled()) &&
+        fear5_sampling_enabled()) {
+        error_report("-mutant-sampling cannot be used in distributed campaigns");
+        exit(1);
+    }
+    if (fear5_cost_enabled() && fear5_dist_coordinator_enabled()) {
+        error_report("-mutant-costs is only available on the workers");
+        exit(1);
+    }
+    if (fear5_taint_enabled() && fear5_dist_coordinator_enabled()) {
+        error_report("-mutant-taint is only available on the workers");
+        exit(1);
+    }
+    /* A coordinator only hands out mutants, it never runs a guest */
+    if (fear5_dist_coordinator_enabled()) {
+        fear5_dist_coordinate();
+    }
+#endif
+
     /*
      * The trace backend must be initialized after daemonizing.
      * trace_init_backends() will call st_init(), which will create the
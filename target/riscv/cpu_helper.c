@@ -25,6 +25,9 @@
 #include "tcg/tcg-op.h"
 #include "trace.h"
 #include "semihosting/common-semi.h"
+#ifdef CONFIG_FEAR5
+#include "fear5/faultinjection.h"
+#endif
 
 int riscv_cpu_mmu_index(CPURISCVState *env, bool ifetch)
 {
@@ -44,7 +47,12 @@ void cpu_get_tb_cpu_state(CPURISCVState *env, target_ulong *pc,
     uint32_t flags = 0;
 
     *pc = env->xl == MXL_RV32 ? env->pc & UINT32_MAX : env->pc;
+#ifdef CONFIG_FEAR5
+    /* cs_base is unused on RISC-V; it carries the FEAR5 fault key instead */
+    *cs_base = f5 ? f5->tb_key : 0;
+#else
     *cs_base = 0;
+#endif
 
     if (riscv_has_ext(env, RVV) || cpu->cfg.ext_zve32f || cpu->cfg.ext_zve64f) {
         /*
@@ -24,6 +24,7 @@
 #include "exec/exec-all.h"
 #ifdef CONFIG_FEAR5
 #include "fear5/faultinjection.h"
+#include "fear5/taint.h"
 #endif
 
 /* CSR function table public API */
@@ -1956,10 +1957,13 @@ static RISCVException riscv_csrrw_do64(CPURISCVState *env, int csrno,
         if (m->kind == CSR_PERMANENT ||
             (m->kind == CSR_TRANSIENT && m->nr_access == (f5->csr[csrno].r + f5->csr[csrno].w))) {
             old_value ^= m->biterror;
+            fear5_taint.csr_read = fear5_taint.csr[csrno] = 1;
         } else if (m->kind == CSR_STUCK_AT_ZERO) {
             old_value &= ~(m->biterror);
+            fear5_taint.csr_read = fear5_taint.csr[csrno] = 1;
         } else if (m->kind == CSR_STUCK_AT_ONE) {
             old_value |= m->biterror;
+            fear5_taint.csr_read = fear5_taint.csr[csrno] = 1;
         }
     }
 #endif
@@ -1979,10 +1983,13 @@ static RISCVException riscv_csrrw_do64(CPURISCVState *env, int csrno,
                 if (m->kind == CSR_PERMANENT ||
                     (m->kind == CSR_TRANSIENT && m->nr_access == (f5->csr[csrno].r + f5->csr[csrno].w))) {
                     new_value ^= m->biterror;
+                    fear5_taint.csr[csrno] = 1;
                 } else if (m->kind == CSR_STUCK_AT_ZERO) {
                     new_value &= ~(m->biterror);
+                    fear5_taint.csr[csrno] = 1;
                 } else if (m->kind == CSR_STUCK_AT_ONE) {
                     new_value |= m->biterror;
+                    fear5_taint.csr[csrno] = 1;
                 }
             }
 #endif
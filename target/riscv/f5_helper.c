@@ -23,6 +23,8 @@
 #include "exec/exec-all.h"
 #include "exec/helper-proto.h"
 #include "fear5/faultinjection.h"
+#include "fear5/taint.h"
+#include "fear5/trace.h"
 
 void helper_f5_trace_gpr_read(target_ulong idx)
 {
@@ -39,6 +41,7 @@ target_ulong helper_f5_mutate_gpr(target_ulong idx, target_ulong reg)
     Mutant* m = FEAR5_CURRENT;
     if (m && m->addr_reg_mem == idx && m->kind == GPR_TRANSIENT && m->nr_access == (f5->gpr[idx].r + f5->gpr[idx].w)) {
         reg ^= m->biterror;
+        fear5_taint.gpr |= 1u << idx;
     }
     return reg;
 }
@@ -81,41 +84,22 @@ void helper_f5_trace_store(target_ulong address, target_ulong mop)
     mem->w++;
 }
 
-target_ulong helper_f5_mutate_memop(target_ulong reg, target_ulong address, target_ulong mop)
+#ifdef CONFIG_USER_ONLY
+/*
+ * DMEM faults in linux-user mode, where no softmmu slow path sees the
+ * accesses.  Called with the value loaded or about to be stored.
+ */
+target_ulong helper_f5_mutate_memop(target_ulong val, target_ulong address,
+                                    target_ulong mop)
 {
-    Mutant* m = FEAR5_CURRENT;
-    // if (m && (m->kind == DMEM_PERMANENT || m->kind == DMEM_STUCK_AT_ZERO || m->kind == DMEM_STUCK_AT_ONE)) {
-
-        unsigned s = memop_size(mop);
-        
-        if (unlikely(m->addr_reg_mem >= address && m->addr_reg_mem < address + s)) {
-            target_ulong e = m->biterror;
-            unsigned offset = m->addr_reg_mem - address;
-            switch(offset) {
-                case 1:
-                    e <<= 8;
-                    break;
-                case 2:
-                    e <<= 16;
-                    break;
-                case 3:
-                    e <<= 24;
-                    break;
-            }
-
-            switch(m->kind) {
-                case DMEM_PERMANENT:
-                    return reg ^= e;
-                case DMEM_STUCK_AT_ZERO:
-                    return reg &= ~e;
-                case DMEM_STUCK_AT_ONE:
-                    return reg |= e;
-            }
-        }
-    // }
-    // Do not mutate otherwise
-    return reg;
+    val = fear5_mutate_memop(address, val, mop);
+    if (mop & MO_SIGN) {
+        /* The bit error may have flipped the sign of a loaded value */
+        val = sextract64(val, 0, memop_size(mop) * 8);
+    }
+    return val;
 }
+#endif
 
 // void helper_f5_trace_mem_filter(target_ulong idx, target_ulong base, target_ulong offset)
 // {
@@ -135,4 +119,14 @@ void helper_f5_trace_tb_exec(target_ulong pc)
         exit(1);
     }
     stats->x++;
-}
\ No newline at end of file
+}
+
+void helper_f5_exec_trace_pc(target_ulong pc)
+{
+    fear5_exec_trace_pc(pc);
+}
+
+void helper_f5_exec_trace_gpr(target_ulong idx, target_ulong val)
+{
+    fear5_exec_trace_gpr(idx, val);
+}
@@ -1118,7 +1118,11 @@ DEF_HELPER_FLAGS_1(f5_trace_gpr_write, TCG_CALL_NO_RWG, void, tl)
 DEF_HELPER_2(f5_mutate_gpr, tl, tl, tl)
 DEF_HELPER_FLAGS_2(f5_trace_load, TCG_CALL_NO_RWG, void, tl, tl)
 DEF_HELPER_FLAGS_2(f5_trace_store, TCG_CALL_NO_RWG, void, tl, tl)
+#ifdef CONFIG_USER_ONLY
 DEF_HELPER_FLAGS_3(f5_mutate_memop, TCG_CALL_NO_RWG, tl, tl, tl, tl)
+#endif
 //DEF_HELPER_3(f5_trace_mem_filter, void, tl, tl, tl)
 DEF_HELPER_FLAGS_1(f5_trace_tb_exec, TCG_CALL_NO_RWG, void, tl)
+DEF_HELPER_FLAGS_1(f5_exec_trace_pc, TCG_CALL_NO_RWG, void, tl)
+DEF_HELPER_FLAGS_2(f5_exec_trace_gpr, TCG_CALL_NO_RWG, void, tl, tl)
 #endif
\ No newline at end of file
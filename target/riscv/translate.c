@@ -45,6 +45,9 @@ static TCGv pm_base;
 
 #ifdef CONFIG_FEAR5
 #include "fear5/faultinjection.h"
+#include "fear5/stats.h"
+#include "fear5/taint.h"
+#include "fear5/trace.h"
 #endif
 
 /*
@@ -107,6 +110,12 @@ typedef struct DisasContext {
     target_ulong vstart;
     bool vl_eq_vlmax;
     uint8_t ntemp;
+    /* goto_tb jump slots used so far, superblocks have more exits */
+    uint8_t goto_tb_used;
+    /* Side exits of a superblock, emitted out of line by tb_stop */
+    uint8_t sb_nexits;
+    TCGLabel *sb_exit[8];
+    target_ulong sb_exit_pc[8];
     CPUState *cs;
     TCGv zero;
     /* Space for 3 operands plus 1 extra for address computation. */
@@ -114,6 +123,22 @@ typedef struct DisasContext {
     /* PointerMasking extension */
     bool pm_mask_enabled;
     bool pm_base_enabled;
+#ifdef CONFIG_FEAR5
+    /* GPRs accessed through fault hooks in this TB */
+    uint32_t f5_gpr_mask;
+    /* Instruction words have to be mutated while decoding */
+    bool f5_insn_fault;
+    /* Instruction count add of -mutant-costs, patched at the end of the TB */
+    TCGOp *f5_icount_op;
+    /* -mutant-taint: shadow state is updated by inline ops */
+    bool f5_taint;
+    /* The current instruction is faulty, everything it writes is tainted */
+    bool f5_taint_force;
+    /* GPRs read by the current instruction */
+    uint32_t f5_taint_src;
+    /* Taint of a loaded value or CSR read by the current instruction */
+    TCGv_i32 f5_taint_extra;
+#endif
 } DisasContext;
 
 static inline bool has_ext(DisasContext *ctx, uint32_t ext)
@@ -243,7 +268,12 @@ static void gen_exception_inst_addr_mis(DisasContext *ctx)
 
 static void gen_goto_tb(DisasContext *ctx, int n, target_ulong dest)
 {
-    if (translator_use_goto_tb(&ctx->base, dest)) {
+    if (ctx->goto_tb_used & (1 << n)) {
+        n ^= 1;
+    }
+    if (!(ctx->goto_tb_used & (1 << n)) &&
+        translator_use_goto_tb(&ctx->base, dest)) {
+        ctx->goto_tb_used |= 1 << n;
         tcg_gen_goto_tb(n);
         gen_set_pc_imm(ctx, dest);
         tcg_gen_exit_tb(ctx->base.tb, n);
@@ -267,10 +297,12 @@ static TCGv temp_new(DisasContext *ctx)
     return ctx->temp[ctx->ntemp++] = tcg_temp_new();
 }
 
-static void _f5_trace_gpr_read(int reg_num)
+static void _f5_trace_gpr_read(DisasContext *ctx, int reg_num)
 {
 #ifdef CONFIG_FEAR5
     Mutant* m = FEAR5_CURRENT;
+    ctx->f5_gpr_mask |= 1u << reg_num;
+    ctx->f5_taint_src |= 1u << reg_num;
     if (unlikely(qemu_loglevel_mask(FEAR5_LOG_GOLDENRUN) ||
                  (m && m->kind == GPR_TRANSIENT && m->addr_reg_mem == reg_num))) {
         TCGv idx = tcg_const_tl(reg_num);
@@ -280,9 +312,10 @@ static void _f5_trace_gpr_read(int reg_num)
 #endif
 }
 
-static void _f5_mutate_gpr(int reg_num) {
+static void _f5_mutate_gpr(DisasContext *ctx, int reg_num) {
     Mutant* m = FEAR5_CURRENT;
     TCGv idx;
+    ctx->f5_gpr_mask |= 1u << reg_num;
     if (m && m->addr_reg_mem == reg_num) {
 
         switch(m->kind) {
@@ -312,11 +345,11 @@ static TCGv get_gpr(DisasContext *ctx, int reg_num, DisasExtend ext)
         return ctx->zero;
     }
 
-    _f5_trace_gpr_read(reg_num);
+    _f5_trace_gpr_read(ctx, reg_num);
     switch (get_ol(ctx)) {
     case MXL_RV32:
 #ifdef CONFIG_FEAR5
-        _f5_mutate_gpr(reg_num);
+        _f5_mutate_gpr(ctx, reg_num);
 #endif
         switch (ext) {
         case EXT_NONE:
@@ -367,10 +400,11 @@ static TCGv dest_gprh(DisasContext *ctx, int reg_num)
     return cpu_gprh[reg_num];
 }
 
-static void _f5_trace_gpr_write(int reg_num)
+static void _f5_trace_gpr_write(DisasContext *ctx, int reg_num)
 {
 #ifdef CONFIG_FEAR5
     Mutant* m = FEAR5_CURRENT;
+    ctx->f5_gpr_mask |= 1u << reg_num;
     if (unlikely(qemu_loglevel_mask(FEAR5_LOG_GOLDENRUN) ||
                  (m && m->kind == GPR_TRANSIENT && m->addr_reg_mem == reg_num))) {
         TCGv idx = tcg_const_tl(reg_num);
@@ -380,15 +414,201 @@ static void _f5_trace_gpr_write(int reg_num)
 #endif
 }
 
+static void _f5_exec_trace_gpr(int reg_num)
+{
+#ifdef CONFIG_FEAR5
+    if (unlikely(fear5_exec_trace_enabled())) {
+        TCGv idx = tcg_const_tl(reg_num);
+        gen_helper_f5_exec_trace_gpr(idx, cpu_gpr[reg_num]);
+        tcg_temp_free(idx);
+    }
+#endif
+}
+
+#ifdef CONFIG_FEAR5
+/* Taint (0 or 1) of everything the current instruction has read so far */
+static TCGv_i32 _f5_taint_sources(DisasContext *ctx)
+{
+    TCGv_i32 t = tcg_temp_new_i32();
+
+    if (ctx->f5_taint_force) {
+        tcg_gen_movi_i32(t, 1);
+        return t;
+    }
+    if (ctx->f5_taint_src) {
+        TCGv_ptr base = tcg_const_ptr(&fear5_taint);
+        tcg_gen_ld_i32(t, base, offsetof(Fear5TaintState, gpr));
+        tcg_gen_andi_i32(t, t, ctx->f5_taint_src);
+        tcg_gen_setcondi_i32(TCG_COND_NE, t, t, 0);
+        tcg_temp_free_ptr(base);
+    } else {
+        tcg_gen_movi_i32(t, 0);
+    }
+    if (ctx->f5_taint_extra) {
+        tcg_gen_or_i32(t, t, ctx->f5_taint_extra);
+    }
+    return t;
+}
+
+/* Host address of the shadow byte of the page that contains addr */
+static TCGv_ptr _f5_taint_page(TCGv addr)
+{
+    TCGv idx = tcg_temp_new();
+    TCGv_ptr page = tcg_temp_new_ptr();
+    TCGv_ptr mem = tcg_const_ptr(fear5_taint.mem);
+
+    tcg_gen_extract_tl(idx, addr, F5_TAINT_PAGE_BITS, 32 - F5_TAINT_PAGE_BITS);
+#if TARGET_LONG_BITS == 32
+    tcg_gen_ext_i32_ptr(page, idx);
+#else
+    tcg_gen_trunc_i64_ptr(page, idx);
+#endif
+    tcg_gen_add_ptr(page, page, mem);
+    tcg_temp_free_ptr(mem);
+    tcg_temp_free(idx);
+    return page;
+}
+#endif
+
+static void _f5_taint_gpr_write(DisasContext *ctx, int reg_num)
+{
+#ifdef CONFIG_FEAR5
+    Mutant* m = FEAR5_CURRENT;
+    if (likely(!ctx->f5_taint)) {
+        return;
+    }
+
+    TCGv_i32 t = _f5_taint_sources(ctx);
+    TCGv_i32 shadow = tcg_temp_new_i32();
+    TCGv_ptr base = tcg_const_ptr(&fear5_taint);
+
+    // Permanent faults are applied again on every write (_f5_mutate_gpr)
+    if (m && m->addr_reg_mem == reg_num &&
+        (m->kind == GPR_PERMANENT || m->kind == GPR_STUCK_AT_ZERO ||
+         m->kind == GPR_STUCK_AT_ONE)) {
+        tcg_gen_movi_i32(t, 1);
+    }
+    tcg_gen_ld_i32(shadow, base, offsetof(Fear5TaintState, gpr));
+    tcg_gen_deposit_i32(shadow, shadow, t, reg_num, 1);
+    tcg_gen_st_i32(shadow, base, offsetof(Fear5TaintState, gpr));
+    tcg_temp_free_ptr(base);
+    tcg_temp_free_i32(shadow);
+    tcg_temp_free_i32(t);
+#endif
+}
+
+static void _f5_taint_load(DisasContext *ctx, TCGv addr)
+{
+#ifdef CONFIG_FEAR5
+    if (likely(!ctx->f5_taint)) {
+        return;
+    }
+
+    TCGv_ptr page = _f5_taint_page(addr);
+    if (!ctx->f5_taint_extra) {
+        ctx->f5_taint_extra = tcg_temp_new_i32();
+    }
+    tcg_gen_ld8u_i32(ctx->f5_taint_extra, page, 0);
+    tcg_temp_free_ptr(page);
+#endif
+}
+
+/* Emitted before the store: address and data taint go to the page */
+static void _f5_taint_store(DisasContext *ctx, TCGv addr)
+{
+#ifdef CONFIG_FEAR5
+    if (likely(!ctx->f5_taint)) {
+        return;
+    }
+
+    TCGv_i32 t = _f5_taint_sources(ctx);
+    TCGv_i32 shadow = tcg_temp_new_i32();
+    TCGv_ptr base = tcg_const_ptr(&fear5_taint);
+    TCGv_ptr page = _f5_taint_page(addr);
+
+    // Checked by the softmmu store path for monitored addresses
+    tcg_gen_st8_i32(t, base, offsetof(Fear5TaintState, st));
+    tcg_gen_ld8u_i32(shadow, page, 0);
+    tcg_gen_or_i32(shadow, shadow, t);
+    tcg_gen_st8_i32(shadow, page, 0);
+    tcg_temp_free_ptr(page);
+    tcg_temp_free_ptr(base);
+    tcg_temp_free_i32(shadow);
+    tcg_temp_free_i32(t);
+#endif
+}
+
+/* Emitted after the store, other stores must not see a stale flag */
+static void _f5_taint_store_done(DisasContext *ctx)
+{
+#ifdef CONFIG_FEAR5
+    if (likely(!ctx->f5_taint)) {
+        return;
+    }
+
+    TCGv_ptr base = tcg_const_ptr(&fear5_taint);
+    tcg_gen_st8_i32(tcg_constant_i32(0), base, offsetof(Fear5TaintState, st));
+    tcg_temp_free_ptr(base);
+#endif
+}
+
+/*
+ * Emitted before a CSR helper call: the CSR is tainted by the source GPR,
+ * rd by the CSR only.
+ */
+static void _f5_taint_csr(DisasContext *ctx, int rc, bool read, bool write)
+{
+#ifdef CONFIG_FEAR5
+    if (likely(!ctx->f5_taint)) {
+        return;
+    }
+
+    TCGv_ptr base = tcg_const_ptr(&fear5_taint);
+    TCGv_i32 old = tcg_temp_new_i32();
+    tcg_gen_ld8u_i32(old, base, offsetof(Fear5TaintState, csr[rc]));
+    if (write) {
+        TCGv_i32 t = _f5_taint_sources(ctx);
+        tcg_gen_or_i32(t, t, old);
+        tcg_gen_st8_i32(t, base, offsetof(Fear5TaintState, csr[rc]));
+        tcg_temp_free_i32(t);
+    }
+    if (read) {
+        ctx->f5_taint_src = 0;
+        ctx->f5_taint_extra = old;
+    } else {
+        tcg_temp_free_i32(old);
+    }
+    tcg_temp_free_ptr(base);
+#endif
+}
+
+/* Emitted after a CSR read: the helper flags values it has mutated */
+static void _f5_taint_csr_done(DisasContext *ctx)
+{
+#ifdef CONFIG_FEAR5
+    if (likely(!ctx->f5_taint) || !ctx->f5_taint_extra) {
+        return;
+    }
+
+    TCGv_ptr base = tcg_const_ptr(&fear5_taint);
+    TCGv_i32 t = tcg_temp_new_i32();
+    tcg_gen_ld8u_i32(t, base, offsetof(Fear5TaintState, csr_read));
+    tcg_gen_or_i32(ctx->f5_taint_extra, ctx->f5_taint_extra, t);
+    tcg_gen_st8_i32(tcg_constant_i32(0), base, offsetof(Fear5TaintState, csr_read));
+    tcg_temp_free_i32(t);
+    tcg_temp_free_ptr(base);
+#endif
+}
+
 static void gen_set_gpr(DisasContext *ctx, int reg_num, TCGv t)
 {
     if (reg_num != 0) {
-        _f5_trace_gpr_write(reg_num);
+        _f5_trace_gpr_write(ctx, reg_num);
         switch (get_ol(ctx)) {
         case MXL_RV32:
             tcg_gen_ext32s_tl(cpu_gpr[reg_num], t);
 #ifdef CONFIG_FEAR5
-            _f5_mutate_gpr(reg_num);
+            _f5_mutate_gpr(ctx, reg_num);
 #endif
             break;
         case MXL_RV64:
@@ -402,18 +622,20 @@ static void gen_set_gpr(DisasContext *ctx, int reg_num, TCGv t)
         if (get_xl_max(ctx) == MXL_RV128) {
             tcg_gen_sari_tl(cpu_gprh[reg_num], cpu_gpr[reg_num], 63);
         }
+        _f5_taint_gpr_write(ctx, reg_num);
+        _f5_exec_trace_gpr(reg_num);
     }
 }
 
 static void gen_set_gpri(DisasContext *ctx, int reg_num, target_long imm)
 {
     if (reg_num != 0) {
-        _f5_trace_gpr_write(reg_num);
+        _f5_trace_gpr_write(ctx, reg_num);
         switch (get_ol(ctx)) {
         case MXL_RV32:
             tcg_gen_movi_tl(cpu_gpr[reg_num], (int32_t)imm);
 #ifdef CONFIG_FEAR5
-            _f5_mutate_gpr(reg_num);
+            _f5_mutate_gpr(ctx, reg_num);
 #endif
             break;
         case MXL_RV64:
@@ -427,6 +649,8 @@ static void gen_set_gpri(DisasContext *ctx, int reg_num, target_long imm)
         if (get_xl_max(ctx) == MXL_RV128) {
             tcg_gen_movi_tl(cpu_gprh[reg_num], -(imm < 0));
         }
+        _f5_taint_gpr_write(ctx, reg_num);
+        _f5_exec_trace_gpr(reg_num);
     }
 }
 
@@ -434,10 +658,35 @@ static void gen_set_gpr128(DisasContext *ctx, int reg_num, TCGv rl, TCGv rh)
 {
     assert(get_ol(ctx) == MXL_RV128);
     if (reg_num != 0) {
-        _f5_trace_gpr_write(reg_num);
+        _f5_trace_gpr_write(ctx, reg_num);
         tcg_gen_mov_tl(cpu_gpr[reg_num], rl);
         tcg_gen_mov_tl(cpu_gprh[reg_num], rh);
+        _f5_taint_gpr_write(ctx, reg_num);
+        _f5_exec_trace_gpr(reg_num);
+    }
+}
+
+/* x1 (ra) and x5 (t0) hold return addresses, see the hints for JALR */
+static bool is_link_reg(int reg)
+{
+    return reg == 1 || reg == 5;
+}
+
+/* The TB flags cpu_get_tb_cpu_state() computes at the end of the TB */
+static uint32_t exit_tb_flags(DisasContext *ctx)
+{
+    uint32_t flags = ctx->base.tb->flags;
+
+    flags &= ~(TB_FLAGS_MSTATUS_FS | TB_FLAGS_MSTATUS_VS);
+    flags |= ctx->mstatus_fs | ctx->mstatus_vs;
+    /* mark_fs_dirty() and mark_vs_dirty() only ever set the dirty state */
+    if (ctx->mstatus_hs_fs != FIELD_EX32(flags, TB_FLAGS, MSTATUS_HS_FS)) {
+        flags = FIELD_DP32(flags, TB_FLAGS, MSTATUS_HS_FS, 3);
     }
+    if (ctx->mstatus_hs_vs != FIELD_EX32(flags, TB_FLAGS, MSTATUS_HS_VS)) {
+        flags = FIELD_DP32(flags, TB_FLAGS, MSTATUS_HS_VS, 3);
+    }
+    return flags;
 }
 
 static void gen_jal(DisasContext *ctx, int rd, target_ulong imm)
@@ -454,6 +703,14 @@ static void gen_jal(DisasContext *ctx, int rd, target_ulong imm)
     }
 
     gen_set_gpri(ctx, rd, ctx->pc_succ_insn);
+    if (is_link_reg(rd)) {
+        translator_ras_push(&ctx->base, ctx->pc_succ_insn);
+    }
+    if (translator_sb_follow(&ctx->base, next_pc)) {
+        /* superblock: go on at the jump target */
+        ctx->pc_succ_insn = next_pc;
+        return;
+    }
     gen_goto_tb(ctx, 0, ctx->base.pc_next + imm); /* must use this for safety */
     ctx->base.is_jmp = DISAS_NORETURN;
 }
@@ -926,41 +1183,73 @@ static uint32_t opcode_at(DisasContextBase *dcbase, target_ulong pc)
 /* Include the auto-generated decoder for 16 bit insn */
 #include "decode-insn16.c.inc"
 
-static inline uint32_t QEMU_ALWAYS_INLINE _f5_get_mutated_insn(uint32_t data, target_ulong addr)
+static inline uint32_t QEMU_ALWAYS_INLINE _f5_get_mutated_insn(DisasContext *ctx, uint32_t data, target_ulong addr)
 {
 #ifdef CONFIG_FEAR5
+    // Softmmu IMEM faults are in guest memory already (fear5/ramsnap.c)
+    if (likely(!ctx->f5_insn_fault)) {
+        return data;
+    }
     Mutant* m = FEAR5_CURRENT;
-    if (m) {
-        if (m->kind == IFR_PERMANENT) {
+    if (m->kind == IFR_PERMANENT) {
+        data ^= m->biterror;
+    } else if (m->kind == IFR_STUCK_AT_ZERO) {
+        data &= ~(m->biterror);
+    } else if (m->kind == IFR_STUCK_AT_ONE) {
+        data |= m->biterror;
+    }
+#ifdef CONFIG_USER_ONLY
+    else if (m->addr_reg_mem == addr) {
+        if (m->kind == IMEM_PERMANENT) {
             data ^= m->biterror;
-        } else if (m->kind == IFR_STUCK_AT_ZERO) {
+        } else if (m->kind == IMEM_STUCK_AT_ZERO) {
             data &= ~(m->biterror);
-        } else if (m->kind == IFR_STUCK_AT_ONE) {
+        } else if (m->kind == IMEM_STUCK_AT_ONE) {
             data |= m->biterror;
-        } else if (m->addr_reg_mem == addr) {
-            if (m->kind == IMEM_PERMANENT) {
-                data ^= m->biterror;
-            } else if (m->kind == IMEM_STUCK_AT_ZERO) {
-                data &= ~(m->biterror);
-            } else if (m->kind == IMEM_STUCK_AT_ONE) {
-                data |= m->biterror;
-            }
         }
     }
+#endif
 #endif
     return data;
 }
 
+static void _f5_taint_insn_start(DisasContext *ctx)
+{
+#ifdef CONFIG_FEAR5
+    Mutant* m = FEAR5_CURRENT;
+
+    ctx->f5_taint_src = 0;
+    ctx->f5_taint_force = false;
+    if (likely(!ctx->f5_taint) || !m) {
+        return;
+    }
+    switch (m->kind) {
+        case IFR_PERMANENT:
+        case IFR_STUCK_AT_ZERO:
+        case IFR_STUCK_AT_ONE:
+            ctx->f5_taint_force = true;
+            break;
+        case IMEM_PERMANENT:
+        case IMEM_STUCK_AT_ZERO:
+        case IMEM_STUCK_AT_ONE:
+            ctx->f5_taint_force = m->addr_reg_mem >= ctx->base.pc_next &&
+                                  m->addr_reg_mem < ctx->pc_succ_insn;
+            break;
+    }
+#endif
+}
+
 static void decode_opc(CPURISCVState *env, DisasContext *ctx, uint16_t opcode)
 {
     /* check for compressed insn */
-    uint16_t opcode16 = _f5_get_mutated_insn(opcode, ctx->base.pc_next);
+    uint16_t opcode16 = _f5_get_mutated_insn(ctx, opcode, ctx->base.pc_next);
     if (extract16(opcode16, 0, 2) != 3) {
         if (!has_ext(ctx, RVC)) {
             gen_exception_illegal(ctx);
         } else {
             ctx->opcode = opcode16;
             ctx->pc_succ_insn = ctx->base.pc_next + 2;
+            _f5_taint_insn_start(ctx);
             if (!decode_insn16(ctx, opcode16)) {
                 gen_exception_illegal(ctx);
             }
@@ -970,9 +1259,10 @@ static void decode_opc(CPURISCVState *env, DisasContext *ctx, uint16_t opcode)
         opcode32 = deposit32(opcode32, 16, 16,
                              translator_lduw(env, &ctx->base,
                                              ctx->base.pc_next + 2));
-        opcode32 = _f5_get_mutated_insn(opcode32, ctx->base.pc_next);
+        opcode32 = _f5_get_mutated_insn(ctx, opcode32, ctx->base.pc_next);
         ctx->opcode = opcode32;
         ctx->pc_succ_insn = ctx->base.pc_next + 4;
+        _f5_taint_insn_start(ctx);
         if (!decode_insn32(ctx, opcode32)) {
             gen_exception_illegal(ctx);
         }
@@ -1021,15 +1311,40 @@ static void riscv_tr_init_disas_context(DisasContextBase *dcbase, CPUState *cs)
     ctx->xl = FIELD_EX32(tb_flags, TB_FLAGS, XL);
     ctx->cs = cs;
     ctx->ntemp = 0;
+    ctx->goto_tb_used = 0;
+    ctx->sb_nexits = 0;
     memset(ctx->temp, 0, sizeof(ctx->temp));
     ctx->pm_mask_enabled = FIELD_EX32(tb_flags, TB_FLAGS, PM_MASK_ENABLED);
     ctx->pm_base_enabled = FIELD_EX32(tb_flags, TB_FLAGS, PM_BASE_ENABLED);
     ctx->zero = tcg_constant_tl(0);
+#ifdef CONFIG_FEAR5
+    ctx->f5_gpr_mask = 0;
+    ctx->f5_insn_fault = fear5_insn_fault_active();
+    ctx->f5_icount_op = NULL;
+    ctx->f5_taint = fear5_taint_enabled();
+    ctx->f5_taint_extra = NULL;
+#endif
 }
 
 static void riscv_tr_tb_start(DisasContextBase *db, CPUState *cpu)
 {
 #ifdef CONFIG_FEAR5
+    DisasContext *ctx = container_of(db, DisasContext, base);
+
+    if (unlikely(fear5_cost_enabled())) {
+        // Add the number of instructions of this TB, which is not known
+        // yet: the immediate is filled in by riscv_tr_tb_stop()
+        TCGv_ptr counter = tcg_const_ptr(&fear5_cost_insns);
+        TCGv_ptr val = tcg_temp_new_ptr();
+        tcg_gen_ld_ptr(val, counter, 0);
+        tcg_gen_add_ptr(val, val,
+                        temp_tcgv_ptr(tcg_constant_internal(TCG_TYPE_PTR, 0)));
+        ctx->f5_icount_op = tcg_last_op();
+        tcg_gen_st_ptr(val, counter, 0);
+        tcg_temp_free_ptr(val);
+        tcg_temp_free_ptr(counter);
+    }
+
 	if (unlikely(qemu_loglevel_mask(FEAR5_LOG_GOLDENRUN))) {
 		// Create new statistics entry for this TB...
 		Fear5TbExecCounter *stats = g_new0(Fear5TbExecCounter, 1);
@@ -1040,6 +1355,13 @@ static void riscv_tr_tb_start(DisasContextBase *db, CPUState *cpu)
 		gen_helper_f5_trace_tb_exec(tmp);
 		tcg_temp_free(tmp);
 	}
+
+    if (unlikely(fear5_exec_trace_enabled())) {
+        // Record the TB entry in the compressed execution trace
+        TCGv pc = tcg_const_tl(db->pc_first);
+        gen_helper_f5_exec_trace_pc(pc);
+        tcg_temp_free(pc);
+    }
 #endif
 }
 
@@ -1050,6 +1372,16 @@ static void riscv_tr_insn_start(DisasContextBase *dcbase, CPUState *cpu)
     tcg_gen_insn_start(ctx->base.pc_next);
 }
 
+static void _f5_taint_insn_end(DisasContext *ctx)
+{
+#ifdef CONFIG_FEAR5
+    if (ctx->f5_taint_extra) {
+        tcg_temp_free_i32(ctx->f5_taint_extra);
+        ctx->f5_taint_extra = NULL;
+    }
+#endif
+}
+
 static void riscv_tr_translate_insn(DisasContextBase *dcbase, CPUState *cpu)
 {
     DisasContext *ctx = container_of(dcbase, DisasContext, base);
@@ -1074,6 +1406,7 @@ static void riscv_tr_translate_insn(DisasContextBase *dcbase, CPUState *cpu)
 
     ctx->ol = ctx->xl;
     decode_opc(env, ctx, opcode16);
+    _f5_taint_insn_end(ctx);
     ctx->base.pc_next = ctx->pc_succ_insn;
 
     for (int i = ctx->ntemp - 1; i >= 0; --i) {
@@ -1105,6 +1438,33 @@ static void riscv_tr_tb_stop(DisasContextBase *dcbase, CPUState *cpu)
     default:
         g_assert_not_reached();
     }
+
+    for (int i = 0; i < ctx->sb_nexits; i++) {
+        gen_set_label(ctx->sb_exit[i]);
+        gen_goto_tb(ctx, 0, ctx->sb_exit_pc[i]);
+    }
+
+#ifdef CONFIG_FEAR5
+    if (ctx->f5_icount_op) {
+        tcg_set_insn_param(ctx->f5_icount_op, 2,
+                           temp_arg(tcg_constant_internal(TCG_TYPE_PTR,
+                                                          ctx->base.num_insns)));
+    }
+    fear5_cost_tbs++;
+
+    /*
+     * Only TBs that carry hooks for the current mutant keep its fault key,
+     * everything else is stored under key 0 and shared across mutants.
+     */
+    ctx->base.tb->f5_gpr_mask = ctx->f5_gpr_mask;
+    if (!fear5_tb_affected(ctx->base.pc_first,
+                           ctx->base.pc_next - ctx->base.pc_first,
+                           ctx->f5_gpr_mask)) {
+        ctx->base.tb->cs_base = 0;
+    } else {
+        ctx->base.tb->cs_base = f5->tb_key;
+    }
+#endif
 }
 
 static void riscv_tr_disas_log(const DisasContextBase *dcbase, CPUState *cpu)
@@ -26,6 +26,9 @@
 #include "fpu/softfloat.h"
 #include "tcg/tcg-gvec-desc.h"
 #include "internals.h"
+#ifdef CONFIG_FEAR5
+#include "fear5/faultinjection.h"
+#endif
 #include <math.h>
 
 target_ulong HELPER(vsetvl)(CPURISCVState *env, target_ulong s1,
@@ -285,6 +288,74 @@ GEN_VEXT_ST_STRIDE(vsse64_v, int64_t, ste_d)
  *** unit-stride: access elements stored contiguously in memory
  */
 
+/*
+ * Copy the elements from vstart up to evl or the end of the page between
+ * vd and guest RAM with one memcpy, for unit-stride accesses with nf = 1.
+ * Return the number of elements copied.
+ *
+ * Otherwise return 0 and set *slow_end to the element up to which
+ * ldst_elem has to be used: the end of the page if it is not plain RAM
+ * (MMIO, a watchpoint, translated code that is stored to), or holds a
+ * FEAR5 monitor or stimulator, which are only seen by the softmmu load
+ * and store helpers.  Just the next element if it crosses the end of the
+ * page, and all elements on big-endian hosts, where elements of vd are
+ * not in guest memory order.
+ *
+ * probe_access_flags() raises a fault for the page with vstart at its
+ * first element, before any element in it is accessed.  Unlike
+ * probe_access() it does not check watchpoints, which are left to
+ * ldst_elem, element by element.
+ */
+static uint32_t
+vext_ldst_us_host(void *vd, target_ulong base, CPURISCVState *env,
+                  uint32_t esz, uint32_t evl, uint32_t *slow_end,
+                  uintptr_t ra, MMUAccessType access_type)
+{
+#ifdef HOST_WORDS_BIGENDIAN
+    *slow_end = evl;
+    return 0;
+#else
+    target_ulong addr = adjust_addr(env, base + (env->vstart << esz));
+    target_ulong pagelen = -(addr | TARGET_PAGE_MASK);
+    uint32_t elems = MIN(pagelen >> esz, evl - env->vstart);
+    uint32_t size = elems << esz;
+    int mmu_idx = cpu_mmu_index(env, false);
+    void *host;
+
+    if (elems == 0) {
+        *slow_end = env->vstart + 1;
+        return 0;
+    }
+    *slow_end = env->vstart + elems;
+
+#ifdef CONFIG_FEAR5
+    if (fear5_io_overlaps(addr, size)) {
+        return 0;
+    }
+#endif
+
+    probe_access_flags(env, addr, access_type, mmu_idx, false, &host, ra);
+    host = tlb_vaddr_to_host(env, addr, access_type, mmu_idx);
+    if (!host) {
+        return 0;
+    }
+
+#ifdef CONFIG_USER_ONLY
+    /* for stores to pages of translated code, as in cpu_st*_data_ra() */
+    set_helper_retaddr(ra);
+#endif
+    if (access_type == MMU_DATA_LOAD) {
+        memcpy(vd + (env->vstart << esz), host, size);
+    } else {
+        memcpy(host, vd + (env->vstart << esz), size);
+    }
+#ifdef CONFIG_USER_ONLY
+    clear_helper_retaddr();
+#endif
+    return elems;
+#endif
+}
+
 /* unmasked unit-stride load and store operation*/
 static void
 vext_ldst_us(void *vd, target_ulong base, CPURISCVState *env, uint32_t desc,
@@ -294,9 +365,21 @@ vext_ldst_us(void *vd, target_ulong base, CPURISCVState *env, uint32_t desc,
     uint32_t i, k;
     uint32_t nf = vext_nf(desc);
     uint32_t max_elems = vext_max_elems(desc, esz);
+    uint32_t slow_end = 0;
 
     /* load bytes from guest memory */
     for (i = env->vstart; i < evl; i++, env->vstart++) {
+        if (nf == 1 && i >= slow_end) {
+            /* the rest of the page at once */
+            uint32_t n = vext_ldst_us_host(vd, base, env, esz, evl,
+                                           &slow_end, ra, access_type);
+            if (n) {
+                i += n - 1;
+                env->vstart += n - 1;
+                continue;
+            }
+        }
+
         k = 0;
         while (k < nf) {
             target_ulong addr = base + ((i * nf + k) << esz);
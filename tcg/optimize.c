@@ -37,6 +37,13 @@
         glue(glue(case INDEX_op_, x), _i64):    \
         glue(glue(case INDEX_op_, x), _vec)
 
+/*
+ * Common subexpression and dead env store elimination are a debug option
+ * (-accel tcg,x-cse=on, or -x-cse in user mode) until their effect on
+ * translation time and code quality has been measured.
+ */
+bool tcg_cse_enabled;
+
 typedef struct TempOptInfo {
     bool is_const;
     TCGTemp *prev_copy;
@@ -44,6 +51,7 @@ typedef struct TempOptInfo {
     uint64_t val;
     uint64_t z_mask;  /* mask bit is 0 if and only if value bit is 0 */
     uint64_t s_mask;  /* a left-aligned mask of clrsb(value) bits. */
+    uint32_t version; /* incremented whenever the value changes */
 } TempOptInfo;
 
 typedef struct OptContext {
@@ -51,6 +59,12 @@ typedef struct OptContext {
     TCGOp *prev_mb;
     TCGTempSet temps_used;
 
+    /* Common subexpression elimination, see fold_cse().  NULL if off. */
+    GHashTable *cse;
+    GPtrArray *cse_mem;     /* entries that read memory */
+    GPtrArray *pending_st;  /* stores not read since */
+    struct CSEEntry *cse_new;
+
     /* In flight values from optimization. */
     uint64_t a_mask;  /* mask bit is 0 iff value identical to first input */
     uint64_t z_mask;  /* mask bit is 0 iff value bit is 0 */
@@ -136,6 +150,7 @@ static void reset_ts(TCGTemp *ts)
     ti->is_const = false;
     ti->z_mask = -1;
     ti->s_mask = 0;
+    ti->version++;
 }
 
 static void reset_temp(TCGArg arg)
@@ -157,6 +172,7 @@ static void init_ts_info(OptContext *ctx, TCGTemp *ts)
     ti = ts->state_ptr;
     if (ti == NULL) {
         ti = tcg_malloc(sizeof(TempOptInfo));
+        ti->version = 0;
         ts->state_ptr = ti;
     }
 
@@ -686,6 +702,344 @@ static void copy_propagate(OptContext *ctx, TCGOp *op,
     }
 }
 
+/*
+ * Common subexpression elimination and dead store elimination.
+ *
+ * Each pure operation with one output is recorded with its opcode and
+ * inputs, after copy propagation.  When the same operation comes up
+ * again while its inputs and the recorded output still hold the same
+ * values, as told by the version of each temp, it becomes a copy.
+ *
+ * Entries live until the end of the extended basic block: at the fall
+ * through of a conditional branch only entries of normal temps, which
+ * die at the branch, are dropped.  Everything is dropped at a label.
+ *
+ * Loads from host memory (i.e. env) are entries as well.  A store drops
+ * the loads it may alias and makes its value available to a later load
+ * of the same slot.  A store that is completely overwritten before the
+ * memory could be read (by a load, a helper or an exception) is removed.
+ */
+
+/* Size of the host memory access of a load or store, 0 for other ops. */
+static int tcg_ldst_size(TCGOpcode opc)
+{
+    switch (opc) {
+    CASE_OP_32_64(ld8u):
+    CASE_OP_32_64(ld8s):
+    CASE_OP_32_64(st8):
+        return 1;
+    CASE_OP_32_64(ld16u):
+    CASE_OP_32_64(ld16s):
+    CASE_OP_32_64(st16):
+        return 2;
+    case INDEX_op_ld_i32:
+    case INDEX_op_ld32u_i64:
+    case INDEX_op_ld32s_i64:
+    case INDEX_op_st_i32:
+    case INDEX_op_st32_i64:
+        return 4;
+    case INDEX_op_ld_i64:
+    case INDEX_op_st_i64:
+        return 8;
+    default:
+        return 0;
+    }
+}
+
+#define CSE_MAX_ARGS  6
+
+typedef struct CSEEntry {
+    TCGOpcode opc;
+    uint8_t param1;
+    uint8_t param2;
+    uint8_t nb_iargs;
+    uint8_t nb_args;
+    TCGArg args[CSE_MAX_ARGS];
+    uint32_t version[CSE_MAX_ARGS];
+    TCGTemp *out;
+    uint32_t out_version;
+} CSEEntry;
+
+typedef struct PendingStore {
+    TCGOp *op;
+    uint32_t base_version;
+} PendingStore;
+
+/* Whether the pending store PS is known to write to BASE + [OFS, OFS+SIZE) */
+static bool pending_st_within(PendingStore *ps, TCGTemp *base,
+                              intptr_t ofs, int size)
+{
+    intptr_t ps_ofs = ps->op->args[2];
+
+    return arg_temp(ps->op->args[1]) == base &&
+           ts_info(base)->version == ps->base_version &&
+           ofs <= ps_ofs && ps_ofs + tcg_ldst_size(ps->op->opc) <= ofs + size;
+}
+
+/* Whether the pending store PS is known not to write to BASE + [OFS...) */
+static bool pending_st_disjoint(PendingStore *ps, TCGTemp *base,
+                                intptr_t ofs, int size)
+{
+    intptr_t ps_ofs = ps->op->args[2];
+
+    return arg_temp(ps->op->args[1]) == base &&
+           ts_info(base)->version == ps->base_version &&
+           (ps_ofs + tcg_ldst_size(ps->op->opc) <= ofs ||
+            ofs + size <= ps_ofs);
+}
+
+static guint cse_hash(gconstpointer p)
+{
+    const CSEEntry *e = p;
+    guint h = e->opc | e->param1 << 8 | e->param2 << 12;
+
+    for (int i = 0; i < e->nb_args; i++) {
+        h = h * 31 + (guint)(e->args[i] ^ (e->args[i] >> 16));
+    }
+    return h;
+}
+
+static gboolean cse_equal(gconstpointer p1, gconstpointer p2)
+{
+    const CSEEntry *e1 = p1, *e2 = p2;
+
+    return e1->opc == e2->opc &&
+           e1->param1 == e2->param1 && e1->param2 == e2->param2 &&
+           e1->nb_args == e2->nb_args &&
+           !memcmp(e1->args, e2->args, e1->nb_args * sizeof(TCGArg));
+}
+
+static bool cse_valid(const CSEEntry *e)
+{
+    for (int i = 0; i < e->nb_iargs; i++) {
+        if (ts_info(arg_temp(e->args[i]))->version != e->version[i]) {
+            return false;
+        }
+    }
+    return ts_info(e->out)->version == e->out_version;
+}
+
+static void cse_insert(OptContext *ctx, CSEEntry *e)
+{
+    g_hash_table_add(ctx->cse, e);
+    if (tcg_ldst_size(e->opc)) {
+        g_ptr_array_add(ctx->cse_mem, e);
+    }
+}
+
+/* Drop the entries that are no longer in the table. */
+static void cse_mem_compact(OptContext *ctx)
+{
+    for (guint i = ctx->cse_mem->len; i-- > 0; ) {
+        CSEEntry *e = g_ptr_array_index(ctx->cse_mem, i);
+        if (g_hash_table_lookup(ctx->cse, e) != e) {
+            g_ptr_array_remove_index_fast(ctx->cse_mem, i);
+        }
+    }
+}
+
+/* Drop the loads that a store of SIZE bytes to BASE + OFS may alias. */
+static void cse_clobber_mem(OptContext *ctx, TCGTemp *base,
+                            intptr_t ofs, int size)
+{
+    for (guint i = ctx->cse_mem->len; i-- > 0; ) {
+        CSEEntry *e = g_ptr_array_index(ctx->cse_mem, i);
+        intptr_t e_ofs = e->args[1];
+
+        if (base && arg_temp(e->args[0]) == base &&
+            (e_ofs + tcg_ldst_size(e->opc) <= ofs || ofs + size <= e_ofs)) {
+            continue;
+        }
+        if (g_hash_table_lookup(ctx->cse, e) == e) {
+            g_hash_table_remove(ctx->cse, e);
+        }
+        g_ptr_array_remove_index_fast(ctx->cse_mem, i);
+    }
+}
+
+/*
+ * Memory may be read (pending stores must stay) or written (loads
+ * may be stale) by the current op.
+ */
+static void cse_mem_barrier(OptContext *ctx, bool read, bool write)
+{
+    if (!ctx->cse) {
+        return;
+    }
+    if (read) {
+        g_ptr_array_set_size(ctx->pending_st, 0);
+    }
+    if (write) {
+        cse_clobber_mem(ctx, NULL, 0, 0);
+    }
+}
+
+static gboolean cse_dies_at_branch(gpointer key, gpointer value,
+                                   gpointer data)
+{
+    CSEEntry *e = value;
+
+    if (e->out->kind == TEMP_NORMAL) {
+        return true;
+    }
+    for (int i = 0; i < e->nb_iargs; i++) {
+        if (arg_temp(e->args[i])->kind == TEMP_NORMAL) {
+            return true;
+        }
+    }
+    return false;
+}
+
+static void cse_bb_end(OptContext *ctx, const TCGOpDef *def)
+{
+    if (!ctx->cse) {
+        return;
+    }
+    g_ptr_array_set_size(ctx->pending_st, 0);
+    if (def->flags & TCG_OPF_COND_BRANCH) {
+        g_hash_table_foreach_remove(ctx->cse, cse_dies_at_branch, NULL);
+        cse_mem_compact(ctx);
+    } else {
+        g_hash_table_remove_all(ctx->cse);
+        g_ptr_array_set_size(ctx->cse_mem, 0);
+    }
+}
+
+/* Fill in opcode and inputs of OP, false if OP is not a candidate. */
+static bool cse_init_entry(CSEEntry *e, TCGOp *op)
+{
+    const TCGOpDef *def = &tcg_op_defs[op->opc];
+    int nb_args = def->nb_iargs + def->nb_cargs;
+
+    if (def->nb_oargs != 1 || nb_args > CSE_MAX_ARGS ||
+        (def->flags & (TCG_OPF_BB_END | TCG_OPF_CALL_CLOBBER |
+                       TCG_OPF_SIDE_EFFECTS | TCG_OPF_NOT_PRESENT))) {
+        return false;
+    }
+    switch (op->opc) {
+    case INDEX_op_ld_vec:
+    case INDEX_op_dupm_vec:
+        /* memory is only tracked for the scalar loads */
+        return false;
+    default:
+        break;
+    }
+
+    memset(e, 0, sizeof(*e));
+    e->opc = op->opc;
+    e->param1 = op->param1;
+    e->param2 = op->param2;
+    e->nb_iargs = def->nb_iargs;
+    e->nb_args = nb_args;
+    for (int i = 0; i < nb_args; i++) {
+        e->args[i] = op->args[def->nb_oargs + i];
+        if (i < def->nb_iargs) {
+            e->version[i] = ts_info(arg_temp(e->args[i]))->version;
+        }
+    }
+    return true;
+}
+
+/*
+ * Replace OP by a copy of an earlier result of the same operation.
+ * Otherwise, leave a new entry in ctx->cse_new for cse_record().
+ */
+static bool fold_cse(OptContext *ctx, TCGOp *op)
+{
+    CSEEntry *e, *prev;
+
+    ctx->cse_new = NULL;
+    if (!ctx->cse) {
+        return false;
+    }
+    e = tcg_malloc(sizeof(CSEEntry));
+    if (!cse_init_entry(e, op)) {
+        return false;
+    }
+
+    prev = g_hash_table_lookup(ctx->cse, e);
+    if (prev && cse_valid(prev)) {
+        init_ts_info(ctx, prev->out);
+#ifdef CONFIG_PROFILER
+        qatomic_set(&ctx->tcg->prof.cse_count, ctx->tcg->prof.cse_count + 1);
+#endif
+        return tcg_opt_gen_mov(ctx, op, op->args[0], temp_arg(prev->out));
+    }
+    ctx->cse_new = e;
+    return false;
+}
+
+/* Called after finish_folding() with the output of the op in place. */
+static void cse_record(OptContext *ctx, TCGOp *op)
+{
+    CSEEntry *e = ctx->cse_new;
+
+    if (e) {
+        e->out = arg_temp(op->args[0]);
+        e->out_version = ts_info(e->out)->version;
+        cse_insert(ctx, e);
+        ctx->cse_new = NULL;
+    }
+}
+
+static bool fold_tcg_st(OptContext *ctx, TCGOp *op)
+{
+    TCGTemp *base = arg_temp(op->args[1]);
+    intptr_t ofs = op->args[2];
+    int size = tcg_ldst_size(op->opc);
+    TCGOpcode ld_opc;
+    PendingStore *ps;
+    CSEEntry *e;
+
+    if (!ctx->cse) {
+        return false;
+    }
+
+    /* Earlier stores to bytes this one overwrites are dead. */
+    for (guint i = ctx->pending_st->len; i-- > 0; ) {
+        ps = g_ptr_array_index(ctx->pending_st, i);
+        if (pending_st_within(ps, base, ofs, size)) {
+            g_ptr_array_remove_index_fast(ctx->pending_st, i);
+            tcg_op_remove(ctx->tcg, ps->op);
+#ifdef CONFIG_PROFILER
+            qatomic_set(&ctx->tcg->prof.dse_count,
+                        ctx->tcg->prof.dse_count + 1);
+#endif
+        }
+    }
+    ps = tcg_malloc(sizeof(PendingStore));
+    ps->op = op;
+    ps->base_version = ts_info(base)->version;
+    g_ptr_array_add(ctx->pending_st, ps);
+
+    cse_clobber_mem(ctx, base, ofs, size);
+
+    /* Forward the stored value to a load of the same slot. */
+    switch (op->opc) {
+    case INDEX_op_st_i32:
+        ld_opc = INDEX_op_ld_i32;
+        break;
+    case INDEX_op_st_i64:
+        ld_opc = INDEX_op_ld_i64;
+        break;
+    default:
+        return false;
+    }
+
+    e = tcg_malloc(sizeof(CSEEntry));
+    memset(e, 0, sizeof(*e));
+    e->opc = ld_opc;
+    e->nb_iargs = 1;
+    e->nb_args = 2;
+    e->args[0] = op->args[1];
+    e->args[1] = ofs;
+    e->version[0] = ts_info(base)->version;
+    e->out = arg_temp(op->args[0]);
+    e->out_version = ts_info(e->out)->version;
+    cse_insert(ctx, e);
+    return false;
+}
+
 static void finish_folding(OptContext *ctx, TCGOp *op)
 {
     const TCGOpDef *def = &tcg_op_defs[op->opc];
@@ -693,11 +1047,12 @@ static void finish_folding(OptContext *ctx, TCGOp *op)
 
     /*
      * For an opcode that ends a BB, reset all temp data.
-     * We do no cross-BB optimization.
+     * Only common subexpressions survive, see cse_bb_end().
      */
     if (def->flags & TCG_OPF_BB_END) {
         memset(&ctx->temps_used, 0, sizeof(ctx->temps_used));
         ctx->prev_mb = NULL;
+        cse_bb_end(ctx, def);
         return;
     }
 
@@ -1216,12 +1571,20 @@ static bool fold_call(OptContext *ctx, TCGOp *op)
         int nb_globals = s->nb_globals;
 
         for (i = 0; i < nb_globals; i++) {
+            TCGTemp *ts = &ctx->tcg->temps[i];
+
             if (test_bit(i, ctx->temps_used.l)) {
-                reset_ts(&ctx->tcg->temps[i]);
+                reset_ts(ts);
+            } else if (ts->state_ptr) {
+                /* still known from before the last branch */
+                ts_info(ts)->version++;
             }
         }
     }
 
+    /* Helpers may read env, or change it unless they are pure. */
+    cse_mem_barrier(ctx, true, !(flags & TCG_CALL_NO_SIDE_EFFECTS));
+
     /* Reset temp data for outputs. */
     for (i = 0; i < nb_oargs; i++) {
         reset_temp(op->args[i]);
@@ -1977,8 +2340,26 @@ static bool fold_sub2(OptContext *ctx, TCGOp *op)
 
 static bool fold_tcg_ld(OptContext *ctx, TCGOp *op)
 {
+    TCGTemp *base = arg_temp(op->args[1]);
+    intptr_t ofs = op->args[2];
+    int size = tcg_ldst_size(op->opc);
+
+    /* Pending stores this load may read have to stay. */
+    if (ctx->cse) {
+        for (guint i = ctx->pending_st->len; i-- > 0; ) {
+            PendingStore *ps = g_ptr_array_index(ctx->pending_st, i);
+
+            if (!pending_st_disjoint(ps, base, ofs, size)) {
+                g_ptr_array_remove_index_fast(ctx->pending_st, i);
+            }
+        }
+    }
+
     /* We can't do any folding with a load, but we can record bits. */
     switch (op->opc) {
+    case INDEX_op_ld_i32:
+    case INDEX_op_ld_i64:
+        break;
     CASE_OP_32_64(ld8s):
         ctx->s_mask = MAKE_64BIT_MASK(8, 56);
         break;
@@ -2039,6 +2420,12 @@ void tcg_optimize(TCGContext *s)
         s->temps[i].state_ptr = NULL;
     }
 
+    if (tcg_cse_enabled) {
+        ctx.cse = g_hash_table_new(cse_hash, cse_equal);
+        ctx.cse_mem = g_ptr_array_new();
+        ctx.pending_st = g_ptr_array_new();
+    }
+
     QTAILQ_FOREACH_SAFE(op, &s->ops, link, op_next) {
         TCGOpcode opc = op->opc;
         const TCGOpDef *def;
@@ -2054,6 +2441,11 @@ void tcg_optimize(TCGContext *s)
         init_arguments(&ctx, op, def->nb_oargs + def->nb_iargs);
         copy_propagate(&ctx, op, def->nb_oargs, def->nb_iargs);
 
+        /* Guest memory accesses may call helpers or raise exceptions. */
+        if (def->flags & (TCG_OPF_CALL_CLOBBER | TCG_OPF_SIDE_EFFECTS)) {
+            cse_mem_barrier(&ctx, true, true);
+        }
+
         /* Pre-compute the type of the operation. */
         if (def->flags & TCG_OPF_VECTOR) {
             ctx.type = TCG_TYPE_V64 + TCGOP_VECL(op);
@@ -2146,10 +2538,15 @@ void tcg_optimize(TCGContext *s)
         CASE_OP_32_64(ld8u):
         CASE_OP_32_64(ld16s):
         CASE_OP_32_64(ld16u):
+        CASE_OP_32_64(ld):
         case INDEX_op_ld32s_i64:
         case INDEX_op_ld32u_i64:
             done = fold_tcg_ld(&ctx, op);
             break;
+        case INDEX_op_ld_vec:
+        case INDEX_op_dupm_vec:
+            cse_mem_barrier(&ctx, true, false);
+            break;
         case INDEX_op_mb:
             done = fold_mb(&ctx, op);
             break;
@@ -2217,6 +2614,16 @@ void tcg_optimize(TCGContext *s)
         CASE_OP_32_64(sextract):
             done = fold_sextract(&ctx, op);
             break;
+        CASE_OP_32_64(st8):
+        CASE_OP_32_64(st16):
+        case INDEX_op_st_i32:
+        case INDEX_op_st32_i64:
+        case INDEX_op_st_i64:
+            done = fold_tcg_st(&ctx, op);
+            break;
+        case INDEX_op_st_vec:
+            cse_mem_barrier(&ctx, false, true);
+            break;
         CASE_OP_32_64(sub):
             done = fold_sub(&ctx, op);
             break;
@@ -2233,8 +2640,18 @@ void tcg_optimize(TCGContext *s)
             break;
         }
 
+        if (!done) {
+            done = fold_cse(&ctx, op);
+        }
         if (!done) {
             finish_folding(&ctx, op);
+            cse_record(&ctx, op);
         }
     }
+
+    if (ctx.cse) {
+        g_hash_table_destroy(ctx.cse);
+        g_ptr_array_free(ctx.cse_mem, true);
+        g_ptr_array_free(ctx.pending_st, true);
+    }
 }
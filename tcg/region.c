@@ -56,6 +56,9 @@ struct tcg_region_state {
     /* fields protected by the lock */
     size_t current; /* current region index */
     size_t agg_size_full; /* aggregate size of full regions */
+    size_t *used; /* code size of each full region, 0 if not full */
+    size_t evict_hand; /* next region to consider for eviction */
+    int probe; /* region probed for the next eviction, or -1 */
 };
 
 static struct tcg_region_state region;
@@ -163,10 +166,22 @@ static void tcg_region_trees_init(void)
     }
 }
 
-static struct tcg_region_tree *tc_ptr_to_region_tree(const void *p)
+static size_t tcg_region_index(const void *p)
 {
-    size_t region_idx;
+    if (p < region.start_aligned) {
+        return 0;
+    } else {
+        ptrdiff_t offset = p - region.start_aligned;
+
+        if (offset > region.stride * (region.n - 1)) {
+            return region.n - 1;
+        }
+        return offset / region.stride;
+    }
+}
 
+static struct tcg_region_tree *tc_ptr_to_region_tree(const void *p)
+{
     /*
      * Like tcg_splitwx_to_rw, with no assert.  The pc may come from
      * a signal handler over which the caller has no control.
@@ -177,19 +192,7 @@ static struct tcg_region_tree *tc_ptr_to_region_tree(const void *p)
             return NULL;
         }
     }
-
-    if (p < region.start_aligned) {
-        region_idx = 0;
-    } else {
-        ptrdiff_t offset = p - region.start_aligned;
-
-        if (offset > region.stride * (region.n - 1)) {
-            region_idx = region.n - 1;
-        } else {
-            region_idx = offset / region.stride;
-        }
-    }
-    return region_trees + region_idx * tree_size;
+    return region_trees + tcg_region_index(p) * tree_size;
 }
 
 void tcg_tb_insert(TranslationBlock *tb)
@@ -283,17 +286,20 @@ size_t tcg_nb_tbs(void)
     return nb_tbs;
 }
 
+static void tcg_region_tree_reset(struct tcg_region_tree *rt)
+{
+    /* Increment the refcount first so that destroy acts as a reset */
+    g_tree_ref(rt->tree);
+    g_tree_destroy(rt->tree);
+}
+
 static void tcg_region_tree_reset_all(void)
 {
     size_t i;
 
     tcg_region_tree_lock_all();
     for (i = 0; i < region.n; i++) {
-        struct tcg_region_tree *rt = region_trees + i * tree_size;
-
-        /* Increment the refcount first so that destroy acts as a reset */
-        g_tree_ref(rt->tree);
-        g_tree_destroy(rt->tree);
+        tcg_region_tree_reset(region_trees + i * tree_size);
     }
     tcg_region_tree_unlock_all();
 }
@@ -346,13 +352,15 @@ static bool tcg_region_alloc__locked(TCGContext *s)
 bool tcg_region_alloc(TCGContext *s)
 {
     bool err;
-    /* read the region size now; alloc__locked will overwrite it on success */
-    size_t size_full = s->code_gen_buffer_size;
+    /* read the region now; alloc__locked will overwrite it on success */
+    size_t full = tcg_region_index(s->code_gen_buffer);
+    size_t size_full = s->code_gen_ptr - s->code_gen_buffer;
 
     qemu_mutex_lock(&region.lock);
     err = tcg_region_alloc__locked(s);
     if (!err) {
-        region.agg_size_full += size_full - TCG_HIGHWATER;
+        region.used[full] = size_full;
+        region.agg_size_full += size_full;
     }
     qemu_mutex_unlock(&region.lock);
     return err;
@@ -384,6 +392,9 @@ void tcg_region_reset_all(void)
     qemu_mutex_lock(&region.lock);
     region.current = 0;
     region.agg_size_full = 0;
+    memset(region.used, 0, region.n * sizeof(*region.used));
+    region.evict_hand = 0;
+    region.probe = -1;
 
     for (i = 0; i < n_ctxs; i++) {
         TCGContext *s = qatomic_read(&tcg_ctxs[i]);
@@ -394,10 +405,137 @@ void tcg_region_reset_all(void)
     tcg_region_tree_reset_all();
 }
 
+struct tcg_region_age {
+    uint32_t epoch;
+    uint32_t age;
+};
+
+static gboolean tcg_region_age_iter(gpointer key, gpointer value,
+                                    gpointer data)
+{
+    const TranslationBlock *tb = value;
+    struct tcg_region_age *a = data;
+
+    a->age = MIN(a->age, a->epoch - qatomic_read(&tb->lookup_epoch));
+    return a->age == 0;
+}
+
+/* Epochs since a TB of region @r was last looked up.  Call with the lock. */
+static uint32_t tcg_region_age(size_t r, uint32_t epoch)
+{
+    struct tcg_region_tree *rt = region_trees + r * tree_size;
+    struct tcg_region_age a = { .epoch = epoch, .age = UINT32_MAX };
+
+    qemu_mutex_lock(&rt->lock);
+    g_tree_foreach(rt->tree, tcg_region_age_iter, &a);
+    qemu_mutex_unlock(&rt->lock);
+    return a.age;
+}
+
+/*
+ * The full region that has gone unused for the most epochs, or -1.  The
+ * region currently used by @own counts as full, pass NULL for none.  Call
+ * with the lock held.
+ */
+static int tcg_region_oldest(TCGContext *own, uint32_t epoch)
+{
+    size_t own_r = own ? tcg_region_index(own->code_gen_buffer) : region.n;
+    uint32_t best_age = 0;
+    int oldest = -1;
+    size_t i;
+
+    for (i = 0; i < region.n; i++) {
+        size_t r = (region.evict_hand + i) % region.n;
+        uint32_t age;
+
+        if (!region.used[r] && r != own_r) {
+            continue;
+        }
+        age = tcg_region_age(r, epoch);
+        if (oldest < 0 || age > best_age) {
+            oldest = r;
+            best_age = age;
+        }
+    }
+    return oldest;
+}
+
+/*
+ * Recycle the full region whose TBs have gone unused for the most epochs
+ * (see TranslationBlock.lookup_epoch), and assign it to @s.  The region
+ * currently used by @s counts as full; regions used by other contexts are
+ * left alone.  @func is called on every TB of the region before its tree
+ * is reset, so that the caller can unlink them.
+ *
+ * TBs entered through chained jumps are never looked up, so the age of a
+ * region can be too high.  Rather than breaking every chain, the oldest
+ * region left after the eviction is probed: @probe is called on its TBs
+ * to unlink the jumps into them.  TBs still in use there are looked up
+ * again, and the next eviction takes this region only if none was.
+ *
+ * Call from a safe-work context.  Returns the index of the recycled region,
+ * or -1 if there was nothing to evict.
+ */
+int tcg_region_evict(TCGContext *s, uint32_t epoch, GTraverseFunc func,
+                     GTraverseFunc probe, gpointer data)
+{
+    size_t own = tcg_region_index(s->code_gen_buffer);
+    size_t own_used = s->code_gen_ptr - s->code_gen_buffer;
+    struct tcg_region_tree *rt;
+    int victim;
+
+    if (region.n == 1) {
+        return -1;
+    }
+
+    qemu_mutex_lock(&region.lock);
+    if (region.probe >= 0 && region.used[region.probe] &&
+        tcg_region_age(region.probe, epoch) > 0) {
+        victim = region.probe;
+    } else {
+        victim = tcg_region_oldest(s, epoch);
+    }
+    g_assert(victim >= 0);
+
+    rt = region_trees + victim * tree_size;
+    qemu_mutex_lock(&rt->lock);
+    g_tree_foreach(rt->tree, func, data);
+    tcg_region_tree_reset(rt);
+    qemu_mutex_unlock(&rt->lock);
+
+    if (victim != own) {
+        region.used[own] = own_used;
+        region.agg_size_full += own_used;
+    }
+    region.agg_size_full -= region.used[victim];
+    region.used[victim] = 0;
+    region.evict_hand = (victim + 1) % region.n;
+    tcg_region_assign(s, victim);
+
+    region.probe = tcg_region_oldest(NULL, epoch);
+    if (region.probe >= 0) {
+        rt = region_trees + region.probe * tree_size;
+        qemu_mutex_lock(&rt->lock);
+        g_tree_foreach(rt->tree, probe, data);
+        qemu_mutex_unlock(&rt->lock);
+    }
+    qemu_mutex_unlock(&region.lock);
+    return victim;
+}
+
+/*
+ * A single TCG context still gets a few regions, so that a full buffer can
+ * be recycled one region at a time instead of being flushed as a whole.
+ */
+static size_t tcg_n_evict_regions(size_t tb_size)
+{
+    return MAX(1, MIN(tb_size / (8 * MiB), 16));
+}
+
 static size_t tcg_n_regions(size_t tb_size, unsigned max_cpus)
 {
 #ifdef CONFIG_USER_ONLY
-    return 1;
+    return tcg_n_evict_regions(tb_size);
 #else
     size_t n_regions;
 
@@ -407,9 +545,9 @@ static size_t tcg_n_regions(size_t tb_size, unsigned max_cpus)
      * being of reasonable size. If that's not possible we make do by evenly
      * dividing the code_gen_buffer among the vCPUs.
      */
-    /* Use a single region if all we have is one vCPU thread */
+    /* Only evict from a few regions if all we have is one vCPU thread */
     if (max_cpus == 1 || !qemu_tcg_mttcg_enabled()) {
-        return 1;
+        return tcg_n_evict_regions(tb_size);
     }
 
     /*
@@ -782,6 +920,8 @@ void tcg_region_init(size_t tb_size, int splitwx, unsigned max_cpus)
 
     /* init the region struct */
     qemu_mutex_init(&region.lock);
+    region.used = g_new0(size_t, region.n);
+    region.probe = -1;
 
     /*
      * Set guard pages in the rw buffer, as that's the one into which
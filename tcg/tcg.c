@@ -4089,6 +4089,8 @@ void tcg_profile_snapshot(TCGProfile *prof, bool counters, bool table)
             PROF_ADD(prof, orig, temp_count);
             PROF_MAX(prof, orig, temp_count_max);
             PROF_ADD(prof, orig, del_op_count);
+            PROF_ADD(prof, orig, cse_count);
+            PROF_ADD(prof, orig, dse_count);
             PROF_ADD(prof, orig, code_in_len);
             PROF_ADD(prof, orig, code_out_len);
             PROF_ADD(prof, orig, search_out_len);
@@ -4415,6 +4417,10 @@ void tcg_dump_info(GString *buf)
                            (double)s->op_count / tb_div_count, s->op_count_max);
     g_string_append_printf(buf, "deleted ops/TB      %0.2f\n",
                            (double)s->del_op_count / tb_div_count);
+    g_string_append_printf(buf, "CSE'd ops/TB        %0.2f\n",
+                           (double)s->cse_count / tb_div_count);
+    g_string_append_printf(buf, "dead stores/TB      %0.2f\n",
+                           (double)s->dse_count / tb_div_count);
     g_string_append_printf(buf, "avg temps/TB        %0.2f max=%d\n",
                            (double)s->temp_count / tb_div_count,
                            s->temp_count_max);
@@ -65,7 +65,7 @@ static uint64_t tci_uint64(uint32_t high, uint32_t low)
  *   m = immediate (MemOpIdx)
  *   n = immediate (call return length)
  *   r = register
- *   s = signed ldst offset
+ *   s = signed ldst offset or immediate
  */
 
 static void tci_args_l(uint32_t insn, const void *tb_ptr, void **l0)
@@ -105,6 +105,18 @@ static void tci_args_ri(uint32_t insn, TCGReg *r0, tcg_target_ulong *i1)
     *i1 = sextract32(insn, 12, 20);
 }
 
+/* The label of tci_brcond is in the word after @insn */
+static void tci_args_rrcl(uint32_t insn, const uint32_t **tb_ptr,
+                          TCGReg *r0, TCGReg *r1, TCGCond *c2, void **l3)
+{
+    int32_t diff = *(*tb_ptr)++;
+
+    *r0 = extract32(insn, 8, 4);
+    *r1 = extract32(insn, 12, 4);
+    *c2 = extract32(insn, 16, 4);
+    *l3 = (void *)*tb_ptr + diff;
+}
+
 static void tci_args_rrm(uint32_t insn, TCGReg *r0,
                          TCGReg *r1, MemOpIdx *m2)
 {
@@ -439,18 +451,48 @@ static void tci_qemu_st(CPUArchState *env, target_ulong taddr, uint64_t val,
 #endif
 }
 
+/*
+ * The interpreter is threaded: every handler is a case of the switch and
+ * also a label, and ends by fetching the next insn and jumping through
+ * tci_dispatch to the label of its opcode.  The switch is only used for
+ * the first insn of a TB.  This replaces the jump back to the top of the
+ * loop and the bounds check of the switch with one indirect jump per
+ * handler, which the host also predicts separately per handler.
+ *
+ * The labels are listed in tci_dispatch with TCI_ENTRY*, under the same
+ * conditions as the handlers.
+ */
+#define CASE_OP(x) \
+        case glue(INDEX_op_, x): glue(tci_op_, x):
+#define TCI_ENTRY(x) \
+        [glue(INDEX_op_, x)] = &&glue(tci_op_, x),
+
 #if TCG_TARGET_REG_BITS == 64
 # define CASE_32_64(x) \
-        case glue(glue(INDEX_op_, x), _i64): \
-        case glue(glue(INDEX_op_, x), _i32):
+        CASE_OP(glue(x, _i64)) \
+        CASE_OP(glue(x, _i32))
 # define CASE_64(x) \
-        case glue(glue(INDEX_op_, x), _i64):
+        CASE_OP(glue(x, _i64))
+# define TCI_ENTRY_32_64(x) \
+        TCI_ENTRY(glue(x, _i64)) \
+        TCI_ENTRY(glue(x, _i32))
+# define TCI_ENTRY_64(x) \
+        TCI_ENTRY(glue(x, _i64))
 #else
 # define CASE_32_64(x) \
-        case glue(glue(INDEX_op_, x), _i32):
+        CASE_OP(glue(x, _i32))
 # define CASE_64(x)
+# define TCI_ENTRY_32_64(x) \
+        TCI_ENTRY(glue(x, _i32))
+# define TCI_ENTRY_64(x)
 #endif
 
+#define TCI_NEXT()                                          \
+    do {                                                    \
+        insn = *tb_ptr++;                                   \
+        goto *tci_dispatch[extract32(insn, 0, 8)];          \
+    } while (0)
+
 /* Interpret pseudo code in tb. */
 /*
  * Disable CFI checks.
@@ -465,6 +507,193 @@ uintptr_t QEMU_DISABLE_CFI tcg_qemu_tb_exec(CPUArchState *env,
     uint64_t stack[(TCG_STATIC_CALL_ARGS_SIZE + TCG_STATIC_FRAME_SIZE)
                    / sizeof(uint64_t)];
     void *call_slots[TCG_STATIC_CALL_ARGS_SIZE / sizeof(uint64_t)];
+    static const void * const tci_dispatch[256] = {
+        [0 ... 255] = &&tci_illegal,
+        TCI_ENTRY(call)
+        TCI_ENTRY(br)
+        TCI_ENTRY(setcond_i32)
+        TCI_ENTRY(movcond_i32)
+#if TCG_TARGET_REG_BITS == 32
+        TCI_ENTRY(setcond2_i32)
+#elif TCG_TARGET_REG_BITS == 64
+        TCI_ENTRY(setcond_i64)
+        TCI_ENTRY(movcond_i64)
+#endif
+        TCI_ENTRY_32_64(mov)
+        TCI_ENTRY(tci_movi)
+        TCI_ENTRY(tci_movl)
+        TCI_ENTRY(tci_addi)
+        TCI_ENTRY(tci_andi)
+        TCI_ENTRY(tci_ori)
+        TCI_ENTRY(tci_xori)
+        TCI_ENTRY(tci_shli)
+        TCI_ENTRY_32_64(ld8u)
+        TCI_ENTRY_32_64(ld8s)
+        TCI_ENTRY_32_64(ld16u)
+        TCI_ENTRY_32_64(ld16s)
+        TCI_ENTRY(ld_i32)
+        TCI_ENTRY_64(ld32u)
+        TCI_ENTRY_32_64(st8)
+        TCI_ENTRY_32_64(st16)
+        TCI_ENTRY(st_i32)
+        TCI_ENTRY_64(st32)
+        TCI_ENTRY_32_64(add)
+        TCI_ENTRY_32_64(sub)
+        TCI_ENTRY_32_64(mul)
+        TCI_ENTRY_32_64(and)
+        TCI_ENTRY_32_64(or)
+        TCI_ENTRY_32_64(xor)
+#if TCG_TARGET_HAS_andc_i32 || TCG_TARGET_HAS_andc_i64
+        TCI_ENTRY_32_64(andc)
+#endif
+#if TCG_TARGET_HAS_orc_i32 || TCG_TARGET_HAS_orc_i64
+        TCI_ENTRY_32_64(orc)
+#endif
+#if TCG_TARGET_HAS_eqv_i32 || TCG_TARGET_HAS_eqv_i64
+        TCI_ENTRY_32_64(eqv)
+#endif
+#if TCG_TARGET_HAS_nand_i32 || TCG_TARGET_HAS_nand_i64
+        TCI_ENTRY_32_64(nand)
+#endif
+#if TCG_TARGET_HAS_nor_i32 || TCG_TARGET_HAS_nor_i64
+        TCI_ENTRY_32_64(nor)
+#endif
+        TCI_ENTRY(div_i32)
+        TCI_ENTRY(divu_i32)
+        TCI_ENTRY(rem_i32)
+        TCI_ENTRY(remu_i32)
+#if TCG_TARGET_HAS_clz_i32
+        TCI_ENTRY(clz_i32)
+#endif
+#if TCG_TARGET_HAS_ctz_i32
+        TCI_ENTRY(ctz_i32)
+#endif
+#if TCG_TARGET_HAS_ctpop_i32
+        TCI_ENTRY(ctpop_i32)
+#endif
+        TCI_ENTRY(shl_i32)
+        TCI_ENTRY(shr_i32)
+        TCI_ENTRY(sar_i32)
+#if TCG_TARGET_HAS_rot_i32
+        TCI_ENTRY(rotl_i32)
+        TCI_ENTRY(rotr_i32)
+#endif
+#if TCG_TARGET_HAS_deposit_i32
+        TCI_ENTRY(deposit_i32)
+#endif
+#if TCG_TARGET_HAS_extract_i32
+        TCI_ENTRY(extract_i32)
+#endif
+#if TCG_TARGET_HAS_sextract_i32
+        TCI_ENTRY(sextract_i32)
+#endif
+        TCI_ENTRY(brcond_i32)
+        TCI_ENTRY(tci_brcond_i32)
+        TCI_ENTRY(tci_shri_i32)
+        TCI_ENTRY(tci_sari_i32)
+#if TCG_TARGET_REG_BITS == 32 || TCG_TARGET_HAS_add2_i32
+        TCI_ENTRY(add2_i32)
+#endif
+#if TCG_TARGET_REG_BITS == 32 || TCG_TARGET_HAS_sub2_i32
+        TCI_ENTRY(sub2_i32)
+#endif
+#if TCG_TARGET_HAS_mulu2_i32
+        TCI_ENTRY(mulu2_i32)
+#endif
+#if TCG_TARGET_HAS_muls2_i32
+        TCI_ENTRY(muls2_i32)
+#endif
+#if TCG_TARGET_HAS_ext8s_i32 || TCG_TARGET_HAS_ext8s_i64
+        TCI_ENTRY_32_64(ext8s)
+#endif
+#if TCG_TARGET_HAS_ext16s_i32 || TCG_TARGET_HAS_ext16s_i64 || \
+    TCG_TARGET_HAS_bswap16_i32 || TCG_TARGET_HAS_bswap16_i64
+        TCI_ENTRY_32_64(ext16s)
+#endif
+#if TCG_TARGET_HAS_ext8u_i32 || TCG_TARGET_HAS_ext8u_i64
+        TCI_ENTRY_32_64(ext8u)
+#endif
+#if TCG_TARGET_HAS_ext16u_i32 || TCG_TARGET_HAS_ext16u_i64
+        TCI_ENTRY_32_64(ext16u)
+#endif
+#if TCG_TARGET_HAS_bswap16_i32 || TCG_TARGET_HAS_bswap16_i64
+        TCI_ENTRY_32_64(bswap16)
+#endif
+#if TCG_TARGET_HAS_bswap32_i32 || TCG_TARGET_HAS_bswap32_i64
+        TCI_ENTRY_32_64(bswap32)
+#endif
+#if TCG_TARGET_HAS_not_i32 || TCG_TARGET_HAS_not_i64
+        TCI_ENTRY_32_64(not)
+#endif
+#if TCG_TARGET_HAS_neg_i32 || TCG_TARGET_HAS_neg_i64
+        TCI_ENTRY_32_64(neg)
+#endif
+#if TCG_TARGET_REG_BITS == 64
+        TCI_ENTRY(ld32s_i64)
+        TCI_ENTRY(ld_i64)
+        TCI_ENTRY(st_i64)
+        TCI_ENTRY(div_i64)
+        TCI_ENTRY(divu_i64)
+        TCI_ENTRY(rem_i64)
+        TCI_ENTRY(remu_i64)
+#if TCG_TARGET_HAS_clz_i64
+        TCI_ENTRY(clz_i64)
+#endif
+#if TCG_TARGET_HAS_ctz_i64
+        TCI_ENTRY(ctz_i64)
+#endif
+#if TCG_TARGET_HAS_ctpop_i64
+        TCI_ENTRY(ctpop_i64)
+#endif
+#if TCG_TARGET_HAS_mulu2_i64
+        TCI_ENTRY(mulu2_i64)
+#endif
+#if TCG_TARGET_HAS_muls2_i64
+        TCI_ENTRY(muls2_i64)
+#endif
+#if TCG_TARGET_HAS_add2_i64
+        TCI_ENTRY(add2_i64)
+#endif
+#if TCG_TARGET_HAS_add2_i64
+        TCI_ENTRY(sub2_i64)
+#endif
+        TCI_ENTRY(shl_i64)
+        TCI_ENTRY(shr_i64)
+        TCI_ENTRY(sar_i64)
+#if TCG_TARGET_HAS_rot_i64
+        TCI_ENTRY(rotl_i64)
+        TCI_ENTRY(rotr_i64)
+#endif
+#if TCG_TARGET_HAS_deposit_i64
+        TCI_ENTRY(deposit_i64)
+#endif
+#if TCG_TARGET_HAS_extract_i64
+        TCI_ENTRY(extract_i64)
+#endif
+#if TCG_TARGET_HAS_sextract_i64
+        TCI_ENTRY(sextract_i64)
+#endif
+        TCI_ENTRY(brcond_i64)
+        TCI_ENTRY(tci_brcond_i64)
+        TCI_ENTRY(tci_shri_i64)
+        TCI_ENTRY(tci_sari_i64)
+        TCI_ENTRY(ext32s_i64)
+        TCI_ENTRY(ext_i32_i64)
+        TCI_ENTRY(ext32u_i64)
+        TCI_ENTRY(extu_i32_i64)
+#if TCG_TARGET_HAS_bswap64_i64
+        TCI_ENTRY(bswap64_i64)
+#endif
+#endif /* TCG_TARGET_REG_BITS == 64 */
+        TCI_ENTRY(exit_tb)
+        TCI_ENTRY(goto_tb)
+        TCI_ENTRY(goto_ptr)
+        TCI_ENTRY(qemu_ld_i32)
+        TCI_ENTRY(qemu_ld_i64)
+        TCI_ENTRY(qemu_st_i32)
+        TCI_ENTRY(qemu_st_i64)
+        TCI_ENTRY(mb)
+    };
 
     regs[TCG_AREG0] = (tcg_target_ulong)env;
     regs[TCG_REG_CALL_STACK] = (uintptr_t)stack;
@@ -491,7 +720,7 @@ uintptr_t QEMU_DISABLE_CFI tcg_qemu_tb_exec(CPUArchState *env,
         opc = extract32(insn, 0, 8);
 
         switch (opc) {
-        case INDEX_op_call:
+        CASE_OP(call)
             /*
              * Set up the ffi_avalue array once, delayed until now
              * because many TB's do not make any calls. In tcg_gen_callN,
@@ -538,51 +767,74 @@ uintptr_t QEMU_DISABLE_CFI tcg_qemu_tb_exec(CPUArchState *env,
             default:
                 g_assert_not_reached();
             }
-            break;
+            TCI_NEXT();
 
-        case INDEX_op_br:
+        CASE_OP(br)
             tci_args_l(insn, tb_ptr, &ptr);
             tb_ptr = ptr;
-            continue;
-        case INDEX_op_setcond_i32:
+            TCI_NEXT();
+        CASE_OP(setcond_i32)
             tci_args_rrrc(insn, &r0, &r1, &r2, &condition);
             regs[r0] = tci_compare32(regs[r1], regs[r2], condition);
-            break;
-        case INDEX_op_movcond_i32:
+            TCI_NEXT();
+        CASE_OP(movcond_i32)
             tci_args_rrrrrc(insn, &r0, &r1, &r2, &r3, &r4, &condition);
             tmp32 = tci_compare32(regs[r1], regs[r2], condition);
             regs[r0] = regs[tmp32 ? r3 : r4];
-            break;
+            TCI_NEXT();
 #if TCG_TARGET_REG_BITS == 32
-        case INDEX_op_setcond2_i32:
+        CASE_OP(setcond2_i32)
             tci_args_rrrrrc(insn, &r0, &r1, &r2, &r3, &r4, &condition);
             T1 = tci_uint64(regs[r2], regs[r1]);
             T2 = tci_uint64(regs[r4], regs[r3]);
             regs[r0] = tci_compare64(T1, T2, condition);
-            break;
+            TCI_NEXT();
 #elif TCG_TARGET_REG_BITS == 64
-        case INDEX_op_setcond_i64:
+        CASE_OP(setcond_i64)
             tci_args_rrrc(insn, &r0, &r1, &r2, &condition);
             regs[r0] = tci_compare64(regs[r1], regs[r2], condition);
-            break;
-        case INDEX_op_movcond_i64:
+            TCI_NEXT();
+        CASE_OP(movcond_i64)
             tci_args_rrrrrc(insn, &r0, &r1, &r2, &r3, &r4, &condition);
             tmp32 = tci_compare64(regs[r1], regs[r2], condition);
             regs[r0] = regs[tmp32 ? r3 : r4];
-            break;
+            TCI_NEXT();
 #endif
         CASE_32_64(mov)
             tci_args_rr(insn, &r0, &r1);
             regs[r0] = regs[r1];
-            break;
-        case INDEX_op_tci_movi:
+            TCI_NEXT();
+        CASE_OP(tci_movi)
             tci_args_ri(insn, &r0, &t1);
             regs[r0] = t1;
-            break;
-        case INDEX_op_tci_movl:
+            TCI_NEXT();
+        CASE_OP(tci_movl)
             tci_args_rl(insn, tb_ptr, &r0, &ptr);
             regs[r0] = *(tcg_target_ulong *)ptr;
-            break;
+            TCI_NEXT();
+
+            /* Superinstructions (mixed 32/64 bit), see tcg_out_opi(). */
+
+        CASE_OP(tci_addi)
+            tci_args_rrs(insn, &r0, &r1, &ofs);
+            regs[r0] = regs[r1] + ofs;
+            TCI_NEXT();
+        CASE_OP(tci_andi)
+            tci_args_rrs(insn, &r0, &r1, &ofs);
+            regs[r0] = regs[r1] & ofs;
+            TCI_NEXT();
+        CASE_OP(tci_ori)
+            tci_args_rrs(insn, &r0, &r1, &ofs);
+            regs[r0] = regs[r1] | ofs;
+            TCI_NEXT();
+        CASE_OP(tci_xori)
+            tci_args_rrs(insn, &r0, &r1, &ofs);
+            regs[r0] = regs[r1] ^ ofs;
+            TCI_NEXT();
+        CASE_OP(tci_shli)
+            tci_args_rrs(insn, &r0, &r1, &ofs);
+            regs[r0] = regs[r1] << (ofs & (TCG_TARGET_REG_BITS - 1));
+            TCI_NEXT();
 
             /* Load/store operations (32 bit). */
 
@@ -590,441 +842,469 @@ uintptr_t QEMU_DISABLE_CFI tcg_qemu_tb_exec(CPUArchState *env,
             tci_args_rrs(insn, &r0, &r1, &ofs);
             ptr = (void *)(regs[r1] + ofs);
             regs[r0] = *(uint8_t *)ptr;
-            break;
+            TCI_NEXT();
         CASE_32_64(ld8s)
             tci_args_rrs(insn, &r0, &r1, &ofs);
             ptr = (void *)(regs[r1] + ofs);
             regs[r0] = *(int8_t *)ptr;
-            break;
+            TCI_NEXT();
         CASE_32_64(ld16u)
             tci_args_rrs(insn, &r0, &r1, &ofs);
             ptr = (void *)(regs[r1] + ofs);
             regs[r0] = *(uint16_t *)ptr;
-            break;
+            TCI_NEXT();
         CASE_32_64(ld16s)
             tci_args_rrs(insn, &r0, &r1, &ofs);
             ptr = (void *)(regs[r1] + ofs);
             regs[r0] = *(int16_t *)ptr;
-            break;
-        case INDEX_op_ld_i32:
+            TCI_NEXT();
+        CASE_OP(ld_i32)
         CASE_64(ld32u)
             tci_args_rrs(insn, &r0, &r1, &ofs);
             ptr = (void *)(regs[r1] + ofs);
             regs[r0] = *(uint32_t *)ptr;
-            break;
+            TCI_NEXT();
         CASE_32_64(st8)
             tci_args_rrs(insn, &r0, &r1, &ofs);
             ptr = (void *)(regs[r1] + ofs);
             *(uint8_t *)ptr = regs[r0];
-            break;
+            TCI_NEXT();
         CASE_32_64(st16)
             tci_args_rrs(insn, &r0, &r1, &ofs);
             ptr = (void *)(regs[r1] + ofs);
             *(uint16_t *)ptr = regs[r0];
-            break;
-        case INDEX_op_st_i32:
+            TCI_NEXT();
+        CASE_OP(st_i32)
         CASE_64(st32)
             tci_args_rrs(insn, &r0, &r1, &ofs);
             ptr = (void *)(regs[r1] + ofs);
             *(uint32_t *)ptr = regs[r0];
-            break;
+            TCI_NEXT();
 
             /* Arithmetic operations (mixed 32/64 bit). */
 
         CASE_32_64(add)
             tci_args_rrr(insn, &r0, &r1, &r2);
             regs[r0] = regs[r1] + regs[r2];
-            break;
+            TCI_NEXT();
         CASE_32_64(sub)
             tci_args_rrr(insn, &r0, &r1, &r2);
             regs[r0] = regs[r1] - regs[r2];
-            break;
+            TCI_NEXT();
         CASE_32_64(mul)
             tci_args_rrr(insn, &r0, &r1, &r2);
             regs[r0] = regs[r1] * regs[r2];
-            break;
+            TCI_NEXT();
         CASE_32_64(and)
             tci_args_rrr(insn, &r0, &r1, &r2);
             regs[r0] = regs[r1] & regs[r2];
-            break;
+            TCI_NEXT();
         CASE_32_64(or)
             tci_args_rrr(insn, &r0, &r1, &r2);
             regs[r0] = regs[r1] | regs[r2];
-            break;
+            TCI_NEXT();
         CASE_32_64(xor)
             tci_args_rrr(insn, &r0, &r1, &r2);
             regs[r0] = regs[r1] ^ regs[r2];
-            break;
+            TCI_NEXT();
 #if TCG_TARGET_HAS_andc_i32 || TCG_TARGET_HAS_andc_i64
         CASE_32_64(andc)
             tci_args_rrr(insn, &r0, &r1, &r2);
             regs[r0] = regs[r1] & ~regs[r2];
-            break;
+            TCI_NEXT();
 #endif
 #if TCG_TARGET_HAS_orc_i32 || TCG_TARGET_HAS_orc_i64
         CASE_32_64(orc)
             tci_args_rrr(insn, &r0, &r1, &r2);
             regs[r0] = regs[r1] | ~regs[r2];
-            break;
+            TCI_NEXT();
 #endif
 #if TCG_TARGET_HAS_eqv_i32 || TCG_TARGET_HAS_eqv_i64
         CASE_32_64(eqv)
             tci_args_rrr(insn, &r0, &r1, &r2);
             regs[r0] = ~(regs[r1] ^ regs[r2]);
-            break;
+            TCI_NEXT();
 #endif
 #if TCG_TARGET_HAS_nand_i32 || TCG_TARGET_HAS_nand_i64
         CASE_32_64(nand)
             tci_args_rrr(insn, &r0, &r1, &r2);
             regs[r0] = ~(regs[r1] & regs[r2]);
-            break;
+            TCI_NEXT();
 #endif
 #if TCG_TARGET_HAS_nor_i32 || TCG_TARGET_HAS_nor_i64
         CASE_32_64(nor)
             tci_args_rrr(insn, &r0, &r1, &r2);
             regs[r0] = ~(regs[r1] | regs[r2]);
-            break;
+            TCI_NEXT();
 #endif
 
             /* Arithmetic operations (32 bit). */
 
-        case INDEX_op_div_i32:
+        CASE_OP(div_i32)
             tci_args_rrr(insn, &r0, &r1, &r2);
             regs[r0] = (int32_t)regs[r1] / (int32_t)regs[r2];
-            break;
-        case INDEX_op_divu_i32:
+            TCI_NEXT();
+        CASE_OP(divu_i32)
             tci_args_rrr(insn, &r0, &r1, &r2);
             regs[r0] = (uint32_t)regs[r1] / (uint32_t)regs[r2];
-            break;
-        case INDEX_op_rem_i32:
+            TCI_NEXT();
+        CASE_OP(rem_i32)
             tci_args_rrr(insn, &r0, &r1, &r2);
             regs[r0] = (int32_t)regs[r1] % (int32_t)regs[r2];
-            break;
-        case INDEX_op_remu_i32:
+            TCI_NEXT();
+        CASE_OP(remu_i32)
             tci_args_rrr(insn, &r0, &r1, &r2);
             regs[r0] = (uint32_t)regs[r1] % (uint32_t)regs[r2];
-            break;
+            TCI_NEXT();
 #if TCG_TARGET_HAS_clz_i32
-        case INDEX_op_clz_i32:
+        CASE_OP(clz_i32)
             tci_args_rrr(insn, &r0, &r1, &r2);
             tmp32 = regs[r1];
             regs[r0] = tmp32 ? clz32(tmp32) : regs[r2];
-            break;
+            TCI_NEXT();
 #endif
 #if TCG_TARGET_HAS_ctz_i32
-        case INDEX_op_ctz_i32:
+        CASE_OP(ctz_i32)
             tci_args_rrr(insn, &r0, &r1, &r2);
             tmp32 = regs[r1];
             regs[r0] = tmp32 ? ctz32(tmp32) : regs[r2];
-            break;
+            TCI_NEXT();
 #endif
 #if TCG_TARGET_HAS_ctpop_i32
-        case INDEX_op_ctpop_i32:
+        CASE_OP(ctpop_i32)
             tci_args_rr(insn, &r0, &r1);
             regs[r0] = ctpop32(regs[r1]);
-            break;
+            TCI_NEXT();
 #endif
 
             /* Shift/rotate operations (32 bit). */
 
-        case INDEX_op_shl_i32:
+        CASE_OP(shl_i32)
             tci_args_rrr(insn, &r0, &r1, &r2);
             regs[r0] = (uint32_t)regs[r1] << (regs[r2] & 31);
-            break;
-        case INDEX_op_shr_i32:
+            TCI_NEXT();
+        CASE_OP(shr_i32)
             tci_args_rrr(insn, &r0, &r1, &r2);
             regs[r0] = (uint32_t)regs[r1] >> (regs[r2] & 31);
-            break;
-        case INDEX_op_sar_i32:
+            TCI_NEXT();
+        CASE_OP(sar_i32)
             tci_args_rrr(insn, &r0, &r1, &r2);
             regs[r0] = (int32_t)regs[r1] >> (regs[r2] & 31);
-            break;
+            TCI_NEXT();
 #if TCG_TARGET_HAS_rot_i32
-        case INDEX_op_rotl_i32:
+        CASE_OP(rotl_i32)
             tci_args_rrr(insn, &r0, &r1, &r2);
             regs[r0] = rol32(regs[r1], regs[r2] & 31);
-            break;
-        case INDEX_op_rotr_i32:
+            TCI_NEXT();
+        CASE_OP(rotr_i32)
             tci_args_rrr(insn, &r0, &r1, &r2);
             regs[r0] = ror32(regs[r1], regs[r2] & 31);
-            break;
+            TCI_NEXT();
 #endif
 #if TCG_TARGET_HAS_deposit_i32
-        case INDEX_op_deposit_i32:
+        CASE_OP(deposit_i32)
             tci_args_rrrbb(insn, &r0, &r1, &r2, &pos, &len);
             regs[r0] = deposit32(regs[r1], pos, len, regs[r2]);
-            break;
+            TCI_NEXT();
 #endif
 #if TCG_TARGET_HAS_extract_i32
-        case INDEX_op_extract_i32:
+        CASE_OP(extract_i32)
             tci_args_rrbb(insn, &r0, &r1, &pos, &len);
             regs[r0] = extract32(regs[r1], pos, len);
-            break;
+            TCI_NEXT();
 #endif
 #if TCG_TARGET_HAS_sextract_i32
-        case INDEX_op_sextract_i32:
+        CASE_OP(sextract_i32)
             tci_args_rrbb(insn, &r0, &r1, &pos, &len);
             regs[r0] = sextract32(regs[r1], pos, len);
-            break;
+            TCI_NEXT();
 #endif
-        case INDEX_op_brcond_i32:
+        CASE_OP(brcond_i32)
             tci_args_rl(insn, tb_ptr, &r0, &ptr);
             if ((uint32_t)regs[r0]) {
                 tb_ptr = ptr;
             }
-            break;
+            TCI_NEXT();
+        CASE_OP(tci_brcond_i32)
+            tci_args_rrcl(insn, &tb_ptr, &r0, &r1, &condition, &ptr);
+            if (tci_compare32(regs[r0], regs[r1], condition)) {
+                tb_ptr = ptr;
+            }
+            TCI_NEXT();
+        CASE_OP(tci_shri_i32)
+            tci_args_rrs(insn, &r0, &r1, &ofs);
+            regs[r0] = (uint32_t)regs[r1] >> (ofs & 31);
+            TCI_NEXT();
+        CASE_OP(tci_sari_i32)
+            tci_args_rrs(insn, &r0, &r1, &ofs);
+            regs[r0] = (int32_t)regs[r1] >> (ofs & 31);
+            TCI_NEXT();
 #if TCG_TARGET_REG_BITS == 32 || TCG_TARGET_HAS_add2_i32
-        case INDEX_op_add2_i32:
+        CASE_OP(add2_i32)
             tci_args_rrrrrr(insn, &r0, &r1, &r2, &r3, &r4, &r5);
             T1 = tci_uint64(regs[r3], regs[r2]);
             T2 = tci_uint64(regs[r5], regs[r4]);
             tci_write_reg64(regs, r1, r0, T1 + T2);
-            break;
+            TCI_NEXT();
 #endif
 #if TCG_TARGET_REG_BITS == 32 || TCG_TARGET_HAS_sub2_i32
-        case INDEX_op_sub2_i32:
+        CASE_OP(sub2_i32)
             tci_args_rrrrrr(insn, &r0, &r1, &r2, &r3, &r4, &r5);
             T1 = tci_uint64(regs[r3], regs[r2]);
             T2 = tci_uint64(regs[r5], regs[r4]);
             tci_write_reg64(regs, r1, r0, T1 - T2);
-            break;
+            TCI_NEXT();
 #endif
 #if TCG_TARGET_HAS_mulu2_i32
-        case INDEX_op_mulu2_i32:
+        CASE_OP(mulu2_i32)
             tci_args_rrrr(insn, &r0, &r1, &r2, &r3);
             tmp64 = (uint64_t)(uint32_t)regs[r2] * (uint32_t)regs[r3];
             tci_write_reg64(regs, r1, r0, tmp64);
-            break;
+            TCI_NEXT();
 #endif
 #if TCG_TARGET_HAS_muls2_i32
-        case INDEX_op_muls2_i32:
+        CASE_OP(muls2_i32)
             tci_args_rrrr(insn, &r0, &r1, &r2, &r3);
             tmp64 = (int64_t)(int32_t)regs[r2] * (int32_t)regs[r3];
             tci_write_reg64(regs, r1, r0, tmp64);
-            break;
+            TCI_NEXT();
 #endif
 #if TCG_TARGET_HAS_ext8s_i32 || TCG_TARGET_HAS_ext8s_i64
         CASE_32_64(ext8s)
             tci_args_rr(insn, &r0, &r1);
             regs[r0] = (int8_t)regs[r1];
-            break;
+            TCI_NEXT();
 #endif
 #if TCG_TARGET_HAS_ext16s_i32 || TCG_TARGET_HAS_ext16s_i64 || \
     TCG_TARGET_HAS_bswap16_i32 || TCG_TARGET_HAS_bswap16_i64
         CASE_32_64(ext16s)
             tci_args_rr(insn, &r0, &r1);
             regs[r0] = (int16_t)regs[r1];
-            break;
+            TCI_NEXT();
 #endif
 #if TCG_TARGET_HAS_ext8u_i32 || TCG_TARGET_HAS_ext8u_i64
         CASE_32_64(ext8u)
             tci_args_rr(insn, &r0, &r1);
             regs[r0] = (uint8_t)regs[r1];
-            break;
+            TCI_NEXT();
 #endif
 #if TCG_TARGET_HAS_ext16u_i32 || TCG_TARGET_HAS_ext16u_i64
         CASE_32_64(ext16u)
             tci_args_rr(insn, &r0, &r1);
             regs[r0] = (uint16_t)regs[r1];
-            break;
+            TCI_NEXT();
 #endif
 #if TCG_TARGET_HAS_bswap16_i32 || TCG_TARGET_HAS_bswap16_i64
         CASE_32_64(bswap16)
             tci_args_rr(insn, &r0, &r1);
             regs[r0] = bswap16(regs[r1]);
-            break;
+            TCI_NEXT();
 #endif
 #if TCG_TARGET_HAS_bswap32_i32 || TCG_TARGET_HAS_bswap32_i64
         CASE_32_64(bswap32)
             tci_args_rr(insn, &r0, &r1);
             regs[r0] = bswap32(regs[r1]);
-            break;
+            TCI_NEXT();
 #endif
 #if TCG_TARGET_HAS_not_i32 || TCG_TARGET_HAS_not_i64
         CASE_32_64(not)
             tci_args_rr(insn, &r0, &r1);
             regs[r0] = ~regs[r1];
-            break;
+            TCI_NEXT();
 #endif
 #if TCG_TARGET_HAS_neg_i32 || TCG_TARGET_HAS_neg_i64
         CASE_32_64(neg)
             tci_args_rr(insn, &r0, &r1);
             regs[r0] = -regs[r1];
-            break;
+            TCI_NEXT();
 #endif
 #if TCG_TARGET_REG_BITS == 64
             /* Load/store operations (64 bit). */
 
-        case INDEX_op_ld32s_i64:
+        CASE_OP(ld32s_i64)
             tci_args_rrs(insn, &r0, &r1, &ofs);
             ptr = (void *)(regs[r1] + ofs);
             regs[r0] = *(int32_t *)ptr;
-            break;
-        case INDEX_op_ld_i64:
+            TCI_NEXT();
+        CASE_OP(ld_i64)
             tci_args_rrs(insn, &r0, &r1, &ofs);
             ptr = (void *)(regs[r1] + ofs);
             regs[r0] = *(uint64_t *)ptr;
-            break;
-        case INDEX_op_st_i64:
+            TCI_NEXT();
+        CASE_OP(st_i64)
             tci_args_rrs(insn, &r0, &r1, &ofs);
             ptr = (void *)(regs[r1] + ofs);
             *(uint64_t *)ptr = regs[r0];
-            break;
+            TCI_NEXT();
 
             /* Arithmetic operations (64 bit). */
 
-        case INDEX_op_div_i64:
+        CASE_OP(div_i64)
             tci_args_rrr(insn, &r0, &r1, &r2);
             regs[r0] = (int64_t)regs[r1] / (int64_t)regs[r2];
-            break;
-        case INDEX_op_divu_i64:
+            TCI_NEXT();
+        CASE_OP(divu_i64)
             tci_args_rrr(insn, &r0, &r1, &r2);
             regs[r0] = (uint64_t)regs[r1] / (uint64_t)regs[r2];
-            break;
-        case INDEX_op_rem_i64:
+            TCI_NEXT();
+        CASE_OP(rem_i64)
             tci_args_rrr(insn, &r0, &r1, &r2);
             regs[r0] = (int64_t)regs[r1] % (int64_t)regs[r2];
-            break;
-        case INDEX_op_remu_i64:
+            TCI_NEXT();
+        CASE_OP(remu_i64)
             tci_args_rrr(insn, &r0, &r1, &r2);
             regs[r0] = (uint64_t)regs[r1] % (uint64_t)regs[r2];
-            break;
+            TCI_NEXT();
 #if TCG_TARGET_HAS_clz_i64
-        case INDEX_op_clz_i64:
+        CASE_OP(clz_i64)
             tci_args_rrr(insn, &r0, &r1, &r2);
             regs[r0] = regs[r1] ? clz64(regs[r1]) : regs[r2];
-            break;
+            TCI_NEXT();
 #endif
 #if TCG_TARGET_HAS_ctz_i64
-        case INDEX_op_ctz_i64:
+        CASE_OP(ctz_i64)
             tci_args_rrr(insn, &r0, &r1, &r2);
             regs[r0] = regs[r1] ? ctz64(regs[r1]) : regs[r2];
-            break;
+            TCI_NEXT();
 #endif
 #if TCG_TARGET_HAS_ctpop_i64
-        case INDEX_op_ctpop_i64:
+        CASE_OP(ctpop_i64)
             tci_args_rr(insn, &r0, &r1);
             regs[r0] = ctpop64(regs[r1]);
-            break;
+            TCI_NEXT();
 #endif
 #if TCG_TARGET_HAS_mulu2_i64
-        case INDEX_op_mulu2_i64:
+        CASE_OP(mulu2_i64)
             tci_args_rrrr(insn, &r0, &r1, &r2, &r3);
             mulu64(&regs[r0], &regs[r1], regs[r2], regs[r3]);
-            break;
+            TCI_NEXT();
 #endif
 #if TCG_TARGET_HAS_muls2_i64
-        case INDEX_op_muls2_i64:
+        CASE_OP(muls2_i64)
             tci_args_rrrr(insn, &r0, &r1, &r2, &r3);
             muls64(&regs[r0], &regs[r1], regs[r2], regs[r3]);
-            break;
+            TCI_NEXT();
 #endif
 #if TCG_TARGET_HAS_add2_i64
-        case INDEX_op_add2_i64:
+        CASE_OP(add2_i64)
             tci_args_rrrrrr(insn, &r0, &r1, &r2, &r3, &r4, &r5);
             T1 = regs[r2] + regs[r4];
             T2 = regs[r3] + regs[r5] + (T1 < regs[r2]);
             regs[r0] = T1;
             regs[r1] = T2;
-            break;
+            TCI_NEXT();
 #endif
 #if TCG_TARGET_HAS_add2_i64
-        case INDEX_op_sub2_i64:
+        CASE_OP(sub2_i64)
             tci_args_rrrrrr(insn, &r0, &r1, &r2, &r3, &r4, &r5);
             T1 = regs[r2] - regs[r4];
             T2 = regs[r3] - regs[r5] - (regs[r2] < regs[r4]);
             regs[r0] = T1;
             regs[r1] = T2;
-            break;
+            TCI_NEXT();
 #endif
 
             /* Shift/rotate operations (64 bit). */
 
-        case INDEX_op_shl_i64:
+        CASE_OP(shl_i64)
             tci_args_rrr(insn, &r0, &r1, &r2);
             regs[r0] = regs[r1] << (regs[r2] & 63);
-            break;
-        case INDEX_op_shr_i64:
+            TCI_NEXT();
+        CASE_OP(shr_i64)
             tci_args_rrr(insn, &r0, &r1, &r2);
             regs[r0] = regs[r1] >> (regs[r2] & 63);
-            break;
-        case INDEX_op_sar_i64:
+            TCI_NEXT();
+        CASE_OP(sar_i64)
             tci_args_rrr(insn, &r0, &r1, &r2);
             regs[r0] = (int64_t)regs[r1] >> (regs[r2] & 63);
-            break;
+            TCI_NEXT();
 #if TCG_TARGET_HAS_rot_i64
-        case INDEX_op_rotl_i64:
+        CASE_OP(rotl_i64)
             tci_args_rrr(insn, &r0, &r1, &r2);
             regs[r0] = rol64(regs[r1], regs[r2] & 63);
-            break;
-        case INDEX_op_rotr_i64:
+            TCI_NEXT();
+        CASE_OP(rotr_i64)
             tci_args_rrr(insn, &r0, &r1, &r2);
             regs[r0] = ror64(regs[r1], regs[r2] & 63);
-            break;
+            TCI_NEXT();
 #endif
 #if TCG_TARGET_HAS_deposit_i64
-        case INDEX_op_deposit_i64:
+        CASE_OP(deposit_i64)
             tci_args_rrrbb(insn, &r0, &r1, &r2, &pos, &len);
             regs[r0] = deposit64(regs[r1], pos, len, regs[r2]);
-            break;
+            TCI_NEXT();
 #endif
 #if TCG_TARGET_HAS_extract_i64
-        case INDEX_op_extract_i64:
+        CASE_OP(extract_i64)
             tci_args_rrbb(insn, &r0, &r1, &pos, &len);
             regs[r0] = extract64(regs[r1], pos, len);
-            break;
+            TCI_NEXT();
 #endif
 #if TCG_TARGET_HAS_sextract_i64
-        case INDEX_op_sextract_i64:
+        CASE_OP(sextract_i64)
             tci_args_rrbb(insn, &r0, &r1, &pos, &len);
             regs[r0] = sextract64(regs[r1], pos, len);
-            break;
+            TCI_NEXT();
 #endif
-        case INDEX_op_brcond_i64:
+        CASE_OP(brcond_i64)
             tci_args_rl(insn, tb_ptr, &r0, &ptr);
             if (regs[r0]) {
                 tb_ptr = ptr;
             }
-            break;
-        case INDEX_op_ext32s_i64:
-        case INDEX_op_ext_i32_i64:
+            TCI_NEXT();
+        CASE_OP(tci_brcond_i64)
+            tci_args_rrcl(insn, &tb_ptr, &r0, &r1, &condition, &ptr);
+            if (tci_compare64(regs[r0], regs[r1], condition)) {
+                tb_ptr = ptr;
+            }
+            TCI_NEXT();
+        CASE_OP(tci_shri_i64)
+            tci_args_rrs(insn, &r0, &r1, &ofs);
+            regs[r0] = regs[r1] >> (ofs & 63);
+            TCI_NEXT();
+        CASE_OP(tci_sari_i64)
+            tci_args_rrs(insn, &r0, &r1, &ofs);
+            regs[r0] = (int64_t)regs[r1] >> (ofs & 63);
+            TCI_NEXT();
+        CASE_OP(ext32s_i64)
+        CASE_OP(ext_i32_i64)
             tci_args_rr(insn, &r0, &r1);
             regs[r0] = (int32_t)regs[r1];
-            break;
-        case INDEX_op_ext32u_i64:
-        case INDEX_op_extu_i32_i64:
+            TCI_NEXT();
+        CASE_OP(ext32u_i64)
+        CASE_OP(extu_i32_i64)
             tci_args_rr(insn, &r0, &r1);
             regs[r0] = (uint32_t)regs[r1];
-            break;
+            TCI_NEXT();
 #if TCG_TARGET_HAS_bswap64_i64
-        case INDEX_op_bswap64_i64:
+        CASE_OP(bswap64_i64)
             tci_args_rr(insn, &r0, &r1);
             regs[r0] = bswap64(regs[r1]);
-            break;
+            TCI_NEXT();
 #endif
 #endif /* TCG_TARGET_REG_BITS == 64 */
 
             /* QEMU specific operations. */
 
-        case INDEX_op_exit_tb:
+        CASE_OP(exit_tb)
             tci_args_l(insn, tb_ptr, &ptr);
             return (uintptr_t)ptr;
 
-        case INDEX_op_goto_tb:
+        CASE_OP(goto_tb)
             tci_args_l(insn, tb_ptr, &ptr);
             tb_ptr = *(void **)ptr;
-            break;
+            TCI_NEXT();
 
-        case INDEX_op_goto_ptr:
+        CASE_OP(goto_ptr)
             tci_args_r(insn, &r0);
             ptr = (void *)regs[r0];
             if (!ptr) {
                 return 0;
             }
             tb_ptr = ptr;
-            break;
+            TCI_NEXT();
 
-        case INDEX_op_qemu_ld_i32:
+        CASE_OP(qemu_ld_i32)
             if (TARGET_LONG_BITS <= TCG_TARGET_REG_BITS) {
                 tci_args_rrm(insn, &r0, &r1, &oi);
                 taddr = regs[r1];
@@ -1034,9 +1314,9 @@ uintptr_t QEMU_DISABLE_CFI tcg_qemu_tb_exec(CPUArchState *env,
             }
             tmp32 = tci_qemu_ld(env, taddr, oi, tb_ptr);
             regs[r0] = tmp32;
-            break;
+            TCI_NEXT();
 
-        case INDEX_op_qemu_ld_i64:
+        CASE_OP(qemu_ld_i64)
             if (TCG_TARGET_REG_BITS == 64) {
                 tci_args_rrm(insn, &r0, &r1, &oi);
                 taddr = regs[r1];
@@ -1054,9 +1334,9 @@ uintptr_t QEMU_DISABLE_CFI tcg_qemu_tb_exec(CPUArchState *env,
             } else {
                 regs[r0] = tmp64;
             }
-            break;
+            TCI_NEXT();
 
-        case INDEX_op_qemu_st_i32:
+        CASE_OP(qemu_st_i32)
             if (TARGET_LONG_BITS <= TCG_TARGET_REG_BITS) {
                 tci_args_rrm(insn, &r0, &r1, &oi);
                 taddr = regs[r1];
@@ -1066,9 +1346,9 @@ uintptr_t QEMU_DISABLE_CFI tcg_qemu_tb_exec(CPUArchState *env,
             }
             tmp32 = regs[r0];
             tci_qemu_st(env, taddr, tmp32, oi, tb_ptr);
-            break;
+            TCI_NEXT();
 
-        case INDEX_op_qemu_st_i64:
+        CASE_OP(qemu_st_i64)
             if (TCG_TARGET_REG_BITS == 64) {
                 tci_args_rrm(insn, &r0, &r1, &oi);
                 taddr = regs[r1];
@@ -1085,13 +1365,14 @@ uintptr_t QEMU_DISABLE_CFI tcg_qemu_tb_exec(CPUArchState *env,
                 tmp64 = tci_uint64(regs[r1], regs[r0]);
             }
             tci_qemu_st(env, taddr, tmp64, oi, tb_ptr);
-            break;
+            TCI_NEXT();
 
-        case INDEX_op_mb:
+        CASE_OP(mb)
             /* Ensure ordering for all kinds */
             smp_mb();
-            break;
+            TCI_NEXT();
         default:
+        tci_illegal:
             g_assert_not_reached();
         }
     }
@@ -1187,6 +1468,14 @@ int print_insn_tci(bfd_vma addr, disassemble_info *info)
                            op_name, str_r(r0), ptr);
         break;
 
+    case INDEX_op_tci_brcond_i32:
+    case INDEX_op_tci_brcond_i64:
+        /* advances tb_ptr past the label word */
+        tci_args_rrcl(insn, &tb_ptr, &r0, &r1, &c, &ptr);
+        info->fprintf_func(info->stream, "%-12s  %s, %s, %s, %p",
+                           op_name, str_r(r0), str_r(r1), str_c(c), ptr);
+        break;
+
     case INDEX_op_setcond_i32:
     case INDEX_op_setcond_i64:
         tci_args_rrrc(insn, &r0, &r1, &r2, &c);
@@ -1225,6 +1514,15 @@ int print_insn_tci(bfd_vma addr, disassemble_info *info)
     case INDEX_op_st32_i64:
     case INDEX_op_st_i32:
     case INDEX_op_st_i64:
+    case INDEX_op_tci_addi:
+    case INDEX_op_tci_andi:
+    case INDEX_op_tci_ori:
+    case INDEX_op_tci_xori:
+    case INDEX_op_tci_shli:
+    case INDEX_op_tci_shri_i32:
+    case INDEX_op_tci_shri_i64:
+    case INDEX_op_tci_sari_i32:
+    case INDEX_op_tci_sari_i64:
         tci_args_rrs(insn, &r0, &r1, &s2);
         info->fprintf_func(info->stream, "%-12s  %s, %s, %d",
                            op_name, str_r(r0), str_r(r1), s2);
@@ -1397,5 +1695,5 @@ int print_insn_tci(bfd_vma addr, disassemble_info *info)
         break;
     }
 
-    return sizeof(insn);
+    return (uintptr_t)tb_ptr - (uintptr_t)addr;
 }
@@ -0,0 +1,50 @@
+/*
+ * FEAR5 benchmark workload - CRC-32 over a pseudo-random buffer
+ *
+ * Copyright (c) 2022 Paderborn University, DE
+ *
+ * SPDX-License-Identifier: GPL-2.0-or-later
+ */
+
+#include "fear5.h"
+
+#define LEN     4096
+#define ROUNDS  8
+
+static uint8_t buf[LEN];
+static uint32_t table[256];
+
+static void crc32_init(void)
+{
+    for (uint32_t i = 0; i < 256; i++) {
+        uint32_t c = i;
+        for (int k = 0; k < 8; k++) {
+            c = (c & 1) ? 0xedb88320 ^ (c >> 1) : c >> 1;
+        }
+        table[i] = c;
+    }
+}
+
+static uint32_t crc32(const uint8_t *p, uint32_t len)
+{
+    uint32_t c = 0xffffffff;
+    while (len--) {
+        c = table[(c ^ *p++) & 0xff] ^ (c >> 8);
+    }
+    return c ^ 0xffffffff;
+}
+
+int main(void)
+{
+    uint32_t x = 0x12345678;
+
+    crc32_init();
+    for (int r = 0; r < ROUNDS; r++) {
+        for (int i = 0; i < LEN; i++) {
+            x = x * 1103515245 + 12345;
+            buf[i] = x >> 16;
+        }
+        f5_signature(crc32(buf, LEN));
+    }
+    return 0;
+}
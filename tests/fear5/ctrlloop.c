@@ -0,0 +1,50 @@
+/*
+ * FEAR5 benchmark workload - fixed-point PI control loop
+ *
+ * Reads the plant disturbance from the stimulated sensor cell and
+ * reports the actuator output of every control period.
+ *
+ * Copyright (c) 2022 Paderborn University, DE
+ *
+ * SPDX-License-Identifier: GPL-2.0-or-later
+ */
+
+#include "fear5.h"
+
+#define STEPS       256
+#define SETPOINT    (1000 << 8)
+#define KP          96      /* Q8 */
+#define KI          12      /* Q8 */
+#define OUT_MAX     (4095 << 8)
+
+int main(void)
+{
+    int32_t y = 0, integ = 0;
+
+    for (int t = 0; t < STEPS; t++) {
+        int32_t dist = (int32_t)f5_sensor() - 128;
+        int32_t e = SETPOINT - y;
+        int32_t u;
+
+        integ += (KI * e) >> 8;
+        if (integ > OUT_MAX) {
+            integ = OUT_MAX;
+        } else if (integ < -OUT_MAX) {
+            integ = -OUT_MAX;
+        }
+
+        u = ((KP * e) >> 8) + integ;
+        if (u > OUT_MAX) {
+            u = OUT_MAX;
+        } else if (u < 0) {
+            u = 0;
+        }
+
+        /* first order plant: y += (u - y) / 16 + disturbance */
+        y += ((u - y) >> 4) + (dist << 4);
+        f5_signature(u >> 8);
+    }
+
+    /* the loop must have settled close to the setpoint */
+    return (y > SETPOINT + (50 << 8) || y < SETPOINT - (50 << 8));
+}
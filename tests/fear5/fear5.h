@@ -0,0 +1,40 @@
+/*
+ * FEAR5 benchmark workloads - common definitions
+ *
+ * Copyright (c) 2022 Paderborn University, DE
+ *
+ * SPDX-License-Identifier: GPL-2.0-or-later
+ */
+
+#ifndef FEAR5_BENCH_H
+#define FEAR5_BENCH_H
+
+#include <stdint.h>
+
+/* -device terminator, see include/hw/riscv/terminator.h */
+#define F5_TERMINATOR       ((volatile uint32_t *)0x10037004)
+#define F5_EXIT_NORMAL      0x00000000
+#define F5_EXIT_FAIL        0x00000001
+
+/* Monitored and stimulated cells (testsetup.xml), unimplemented PWM2 */
+#define F5_SIGNATURE        ((volatile uint32_t *)0x10035000)
+#define F5_SENSOR           ((volatile uint32_t *)0x10035004)
+
+static inline void f5_signature(uint32_t v)
+{
+    *F5_SIGNATURE = v;
+}
+
+static inline uint32_t f5_sensor(void)
+{
+    return *F5_SENSOR;
+}
+
+static inline void __attribute__((noreturn)) f5_exit(uint32_t code)
+{
+    *F5_TERMINATOR = code;
+    for (;;) {
+    }
+}
+
+#endif
@@ -0,0 +1,87 @@
+#!/usr/bin/env python3
+#
+# Generate a FEAR5 mutant list covering every mutant type for an ELF
+#
+# Copyright (c) 2022 Paderborn University, DE
+#
+# SPDX-License-Identifier: GPL-2.0-or-later
+#
+# Output format (one mutant per line, see fear5_gotonext_mutant()):
+#   id,kind,addr_reg_mem,nr_access,biterror(hex)
+
+import argparse
+import random
+import struct
+
+# enum MutantType in include/fear5/faultinjection.h
+GPR_KINDS = [1, 2, 10, 11]          # permanent, transient, stuck-at-0/1
+CSR_KINDS = [3, 4, 30, 31]
+IMEM_KINDS = [5, 50, 51]
+IFR_KINDS = [7, 70, 71]
+DMEM_KINDS = [8, 9, 80, 81]
+TRANSIENT = [2, 4, 9]
+
+# CSRs touched by crt0.S and the trap path
+CSRS = [0x300, 0x305, 0x341, 0x342, 0xb00, 0xb02]
+
+
+def elf_sections(path):
+    '''Return {name: (addr, size)} for an ELF32 little endian file'''
+    with open(path, 'rb') as f:
+        data = f.read()
+    if data[:4] != b'\x7fELF' or data[4] != 1:
+        raise ValueError('%s: not an ELF32 file' % path)
+    shoff, = struct.unpack_from('<I', data, 0x20)
+    shentsize, shnum, shstrndx = struct.unpack_from('<HHH', data, 0x2e)
+    hdrs = [struct.unpack_from('<IIIIIIIIII', data, shoff + i * shentsize)
+            for i in range(shnum)]
+    strtab = hdrs[shstrndx][4]
+    sections = {}
+    for h in hdrs:
+        name = data[strtab + h[0]:data.index(b'\0', strtab + h[0])]
+        sections[name.decode()] = (h[3], h[5])
+    return sections
+
+
+def main():
+    parser = argparse.ArgumentParser(
+        description='Generate a FEAR5 mutant list for an ELF file')
+    parser.add_argument('-n', type=int, default=50,
+                        help='mutants per mutant type')
+    parser.add_argument('--seed', type=int, default=0)
+    parser.add_argument('--max-access', type=int, default=1000,
+                        help='upper bound for transient access numbers')
+    parser.add_argument('elf')
+    args = parser.parse_args()
+
+    rnd = random.Random(args.seed)
+    sec = elf_sections(args.elf)
+    text = sec['.text']
+    data_lo = sec['.data'][0]
+    data_hi = sec['.bss'][0] + sec['.bss'][1]
+
+    print('# mutants for %s: %d per type' % (args.elf, args.n))
+    mid = 0
+    for kinds, width in ((GPR_KINDS, 32), (CSR_KINDS, 32), (IMEM_KINDS, 32),
+                         (IFR_KINDS, 32), (DMEM_KINDS, 8)):
+        for kind in kinds:
+            for _ in range(args.n):
+                if kinds is GPR_KINDS:
+                    addr = rnd.randint(1, 31)
+                elif kinds is CSR_KINDS:
+                    addr = rnd.choice(CSRS)
+                elif kinds is IMEM_KINDS:
+                    addr = text[0] + 4 * rnd.randrange(text[1] // 4)
+                elif kinds is IFR_KINDS:
+                    addr = 0
+                else:
+                    addr = rnd.randrange(data_lo, max(data_hi, data_lo + 1))
+                access = rnd.randint(1, args.max_access) \
+                    if kind in TRANSIENT else 0
+                biterror = 1 << rnd.randrange(width)
+                print('%d,%d,%d,%d,%x' % (mid, kind, addr, access, biterror))
+                mid += 1
+
+
+if __name__ == '__main__':
+    main()
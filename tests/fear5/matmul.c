@@ -0,0 +1,43 @@
+/*
+ * FEAR5 benchmark workload - integer matrix multiplication
+ *
+ * Copyright (c) 2022 Paderborn University, DE
+ *
+ * SPDX-License-Identifier: GPL-2.0-or-later
+ */
+
+#include "fear5.h"
+
+#define N 24
+
+static int32_t a[N][N], b[N][N], c[N][N];
+
+int main(void)
+{
+    for (int i = 0; i < N; i++) {
+        for (int j = 0; j < N; j++) {
+            a[i][j] = i + j;
+            b[i][j] = i - j;
+        }
+    }
+
+    for (int i = 0; i < N; i++) {
+        for (int j = 0; j < N; j++) {
+            int32_t sum = 0;
+            for (int k = 0; k < N; k++) {
+                sum += a[i][k] * b[k][j];
+            }
+            c[i][j] = sum;
+        }
+    }
+
+    /* one signature word per row */
+    for (int i = 0; i < N; i++) {
+        uint32_t h = 0;
+        for (int j = 0; j < N; j++) {
+            h = (h << 5) ^ (h >> 27) ^ c[i][j];
+        }
+        f5_signature(h);
+    }
+    return 0;
+}
@@ -0,0 +1,153 @@
+#!/usr/bin/env python3
+#
+# Run the FEAR5 campaign throughput benchmarks
+#
+# Copyright (c) 2022 Paderborn University, DE
+#
+# SPDX-License-Identifier: GPL-2.0-or-later
+#
+# For every workload <name> this expects <name>.elf and <name>.mutants in
+# the current directory (see Makefile) and reports:
+#
+#   golden overhead   golden run (-d goldenrun) wall time vs. plain TCG
+#   mutants/s         campaign throughput
+#   reset us          average time between two mutants (see --reset)
+#   reset share       share of campaign time spent between two mutants
+#   jit share         share of campaign time spent translating
+#                     (needs a build with --enable-profiler)
+
+import argparse
+import json
+import os
+import re
+import struct
+import subprocess
+import sys
+import tempfile
+import time
+
+sys.path.append(os.path.join(os.path.dirname(__file__), '..', '..', 'python'))
+from qemu.aqmp.legacy import QEMUMonitorProtocol
+
+
+def qemu_cmd(args, elf, extra=()):
+    return [args.qemu, '-M', 'sifive_e', '-display', 'none',
+            '-serial', 'null', '-monitor', 'none',
+            '-kernel', elf, '-device', 'terminator',
+            '-test-setup', args.setup] + list(extra)
+
+
+def timed_run(cmd):
+    start = time.perf_counter()
+    subprocess.run(cmd, check=True, stdout=subprocess.DEVNULL,
+                   stderr=subprocess.DEVNULL)
+    return time.perf_counter() - start
+
+
+def jit_seconds(qmp):
+    out = qmp.command('human-monitor-command', command_line='info jit')
+    m = re.search(r'JIT cycles\s+\d+ \(([0-9.]+) s', out)
+    return float(m.group(1)) if m else None
+
+
+def campaign(args, name, tmp):
+    '''Run the full campaign, sampling statistics over QMP'''
+    sock = os.path.join(tmp, 'qmp.sock')
+    cmd = qemu_cmd(args, name + '.elf',
+                   ['-mutant-list', name + '.mutants',
+                    '-test-report', name + '.report',
+                    '-mutant-reset', args.reset,
+                    '-qmp', 'unix:%s,server=on,wait=off' % sock])
+
+    start = time.perf_counter()
+    proc = subprocess.Popen(cmd, stdout=subprocess.DEVNULL,
+                            stderr=subprocess.DEVNULL)
+    while not os.path.exists(sock) and proc.poll() is None:
+        time.sleep(0.01)
+
+    info, jit, elapsed = None, None, None
+    try:
+        qmp = QEMUMonitorProtocol(sock)
+        qmp.connect()
+        while proc.poll() is None:
+            info = qmp.command('query-fear5-campaign')
+            jit = jit_seconds(qmp)
+            elapsed = time.perf_counter() - start
+            time.sleep(args.interval)
+    except Exception:
+        # QEMU exits right after the last mutant
+        pass
+    proc.wait()
+    total = time.perf_counter() - start
+
+    res = {'campaign-s': total}
+    if info and info['completed']:
+        res['mutants'] = info['total']
+        res['mutants-per-s'] = info['mutants-per-second']
+        res['reset-us'] = info['avg-reset-overhead-us']
+        res['reset-share'] = (info['avg-reset-overhead-us'] / 1e6 *
+                              info['completed'] / elapsed)
+        res['results'] = info['results']
+        if jit is not None:
+            res['jit-share'] = jit / elapsed
+    return res
+
+
+def bench(args, name):
+    if not os.path.exists('sensor.bin'):
+        with open('sensor.bin', 'wb') as f:
+            for i in range(4096):
+                f.write(struct.pack('<I', 128 + (i * 7919) % 21 - 10))
+
+    plain = min(timed_run(qemu_cmd(args, name + '.elf'))
+                for _ in range(args.repeat))
+    golden = min(timed_run(qemu_cmd(args, name + '.elf',
+                                    ['-d', 'goldenrun', '-D', os.devnull]))
+                 for _ in range(args.repeat))
+
+    with tempfile.TemporaryDirectory() as tmp:
+        res = campaign(args, name, tmp)
+    res['plain-s'] = plain
+    res['golden-s'] = golden
+    res['golden-overhead'] = golden / plain
+    return res
+
+
+def fmt(res, key, f):
+    return f % res[key] if key in res else 'n/a'
+
+
+def main():
+    parser = argparse.ArgumentParser(
+        description='Run the FEAR5 campaign throughput benchmarks')
+    parser.add_argument('--qemu', required=True)
+    parser.add_argument('--setup', required=True, help='test setup XML')
+    parser.add_argument('--repeat', type=int, default=3,
+                        help='runs for the plain/golden timings')
+    parser.add_argument('--interval', type=float, default=0.1,
+                        help='QMP sampling interval in seconds')
+    parser.add_argument('--reset', choices=('fast', 'full'), default='fast',
+                        help='device reset between two mutants')
+    parser.add_argument('--json', help='also write results to this file')
+    parser.add_argument('workloads', nargs='+')
+    args = parser.parse_args()
+
+    results = {}
+    print('%-10s %10s %10s %12s %10s %12s %10s' %
+          ('workload', 'golden x', 'mutants', 'mutants/s', 'reset us',
+           'reset share', 'jit share'))
+    for name in args.workloads:
+        res = results[name] = bench(args, name)
+        print('%-10s %10s %10s %12s %10s %12s %10s' %
+              (name, fmt(res, 'golden-overhead', '%.2f'),
+               fmt(res, 'mutants', '%d'), fmt(res, 'mutants-per-s', '%.1f'),
+               fmt(res, 'reset-us', '%.1f'), fmt(res, 'reset-share', '%.3f'),
+               fmt(res, 'jit-share', '%.3f')))
+
+    if args.json:
+        with open(args.json, 'w') as f:
+            json.dump(results, f, indent=2)
+
+
+if __name__ == '__main__':
+    main()
@@ -0,0 +1,127 @@
+#!/usr/bin/env python3
+#
+# Check a distributed FEAR5 campaign over a local socket
+#
+# Copyright (c) 2022 Paderborn University, DE
+#
+# SPDX-License-Identifier: GPL-2.0-or-later
+#
+# For every workload <name> this expects <name>.elf and <name>.mutants in
+# the current directory (see Makefile).  The campaign is run once in a
+# single QEMU and once by a -mutant-coordinator with two -mutant-worker
+# QEMUs on a Unix socket.  A third client connects first and sends only
+# half of a HELLO, which must not keep the coordinator from serving the
+# workers.  Both reports must have the same result for every mutant.
+
+import argparse
+import os
+import re
+import socket
+import struct
+import subprocess
+import sys
+import tempfile
+import time
+
+RESULT = re.compile(r'^\s+(\d+),\s+(.+?),\s+\d+ us')
+F5_DIST_HELLO = 1
+
+
+def qemu_cmd(args, name, report, extra=()):
+    return [args.qemu, '-M', 'sifive_e', '-display', 'none',
+            '-serial', 'null', '-monitor', 'none',
+            '-kernel', name + '.elf', '-device', 'terminator',
+            '-test-setup', args.setup,
+            '-mutant-list', name + '.mutants',
+            '-test-report', report] + list(extra)
+
+
+def results(report):
+    with open(report) as f:
+        return [m.groups() for m in map(RESULT.match, f) if m]
+
+
+def wait_for(path, proc):
+    while not os.path.exists(path):
+        if proc.poll() is not None:
+            sys.exit('coordinator exited with %d' % proc.returncode)
+        time.sleep(0.01)
+
+
+def distributed(args, name, tmp):
+    sock = os.path.join(tmp, 'dist.sock')
+    report = os.path.join(tmp, name + '.dist.report')
+    coord = subprocess.Popen(qemu_cmd(args, name, report,
+                                      ['-mutant-coordinator', 'unix:' + sock]))
+    workers = []
+    try:
+        wait_for(sock, coord)
+
+        # Half a message, then nothing: a blocking read would hang here
+        stall = socket.socket(socket.AF_UNIX, socket.SOCK_STREAM)
+        stall.connect(sock)
+        stall.send(struct.pack('>III', F5_DIST_HELLO, 0, 0)[:6])
+
+        for i in range(2):
+            workers.append(subprocess.Popen(
+                qemu_cmd(args, name, os.path.join(tmp, 'worker%d' % i),
+                         ['-mutant-worker', 'unix:' + sock]),
+                stdout=subprocess.DEVNULL, stderr=subprocess.DEVNULL))
+        try:
+            coord.wait(timeout=args.timeout)
+        except subprocess.TimeoutExpired:
+            sys.exit('%s: coordinator did not finish in %d s' %
+                     (name, args.timeout))
+        stall.close()
+    finally:
+        for p in workers + [coord]:
+            if p.poll() is None:
+                p.kill()
+            p.wait()
+    if coord.returncode != 0:
+        sys.exit('%s: coordinator exited with %d' % (name, coord.returncode))
+    return results(report)
+
+
+def check(args, name):
+    # Same sensor input as run-bench.py
+    if not os.path.exists('sensor.bin'):
+        with open('sensor.bin', 'wb') as f:
+            for i in range(4096):
+                f.write(struct.pack('<I', 128 + (i * 7919) % 21 - 10))
+
+    with tempfile.TemporaryDirectory() as tmp:
+        report = os.path.join(tmp, name + '.report')
+        subprocess.run(qemu_cmd(args, name, report), check=True,
+                       stdout=subprocess.DEVNULL, stderr=subprocess.DEVNULL)
+        local = results(report)
+        dist = distributed(args, name, tmp)
+
+    if not local:
+        sys.exit('%s: no mutant results in the report' % name)
+    if local != dist:
+        for a, b in zip(local, dist):
+            if a != b:
+                print('%s: mutant %s: %s locally, %s distributed' %
+                      (name, a[0], a[1], b[1]))
+        sys.exit('%s: distributed campaign differs (%d vs. %d results)' %
+                 (name, len(local), len(dist)))
+    print('%-10s %d mutants OK' % (name, len(local)))
+
+
+def main():
+    parser = argparse.ArgumentParser(
+        description='Check a distributed FEAR5 campaign over a local socket')
+    parser.add_argument('--qemu', required=True)
+    parser.add_argument('--setup', required=True, help='test setup XML')
+    parser.add_argument('--timeout', type=int, default=300,
+                        help='seconds to wait for the coordinator')
+    parser.add_argument('workloads', nargs='+')
+    args = parser.parse_args()
+
+    for name in args.workloads:
+        check(args, name)
+
+
+if __name__ == '__main__':
+    main()
@@ -0,0 +1,42 @@
+/*
+ * FEAR5 linux-user check - DMEM faults in code that ran before main()
+ *
+ * checksum() is translated by a constructor, before the fork server
+ * starts at main().  A DMEM mutant on table[] must still see the fault
+ * when main() runs checksum() again, so the hook-free translation from
+ * before main() must not be reused.
+ *
+ * Copyright (c) 2022 Paderborn University, DE
+ *
+ * SPDX-License-Identifier: GPL-2.0-or-later
+ */
+
+#include <stdint.h>
+#include <stdio.h>
+
+uint8_t table[64] = {
+    0x55, 0x55, 0x55, 0x55, 0x55, 0x55, 0x55, 0x55,
+};
+
+static uint32_t early;
+
+static uint32_t __attribute__((noinline)) checksum(void)
+{
+    uint32_t sum = 0;
+
+    for (unsigned i = 0; i < sizeof(table); i++) {
+        sum = sum * 31 + table[i];
+    }
+    return sum;
+}
+
+static void __attribute__((constructor)) before_main(void)
+{
+    early = checksum();
+}
+
+int main(void)
+{
+    printf("%08x %08x\n", early, checksum());
+    return 0;
+}
@@ -322,6 +322,12 @@ for target in $target_list; do
                   echo "CROSS_CC_HAS_POWER10=y" >> $config_target_mak
               fi
               ;;
+          riscv64-*)
+              if do_compiler "$target_compiler" $target_compiler_cflags \
+                             -march=rv64gcv -o $TMPE $TMPC; then
+                  echo "CROSS_CC_HAS_RVV=y" >> $config_target_mak
+              fi
+              ;;
           i386-linux-user)
               if do_compiler "$target_compiler" $target_compiler_cflags \
                              -Werror -fno-pie -o $TMPE $TMPC; then
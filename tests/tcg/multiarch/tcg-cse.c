@@ -0,0 +1,171 @@
+/*
+ * Common subexpression and dead store elimination in the TCG optimizer
+ *
+ * The same values are computed again after helper calls, guest memory
+ * accesses, faults and memory barriers.  Forwarding a value across any
+ * of these, or dropping a store of CPU state that one of them reads,
+ * shows up as a wrong result here.  The pass is off by default, so the
+ * test runs with -x-cse.
+ *
+ * Copyright (c) 2022 Paderborn University, DE
+ *
+ * SPDX-License-Identifier: GPL-2.0-or-later
+ */
+
+#include <fenv.h>
+#include <pthread.h>
+#include <setjmp.h>
+#include <signal.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+static volatile int errors;
+
+#define check(cond) do {                                        \
+        if (!(cond)) {                                          \
+            fprintf(stderr, "%s:%d: %s failed\n",               \
+                    __FILE__, __LINE__, #cond);                 \
+            errors++;                                           \
+        }                                                       \
+    } while (0)
+
+/*
+ * Floating point flags are CPU state that the FP helpers update and
+ * the flag accessors read back.
+ */
+static void test_helpers(void)
+{
+#ifdef FE_DIVBYZERO
+    volatile double zero = 0.0, one = 1.0, r;
+
+    for (int i = 0; i < 4; i++) {
+        feclearexcept(FE_ALL_EXCEPT);
+        check(!fetestexcept(FE_DIVBYZERO));
+        r = one / zero;
+        check(fetestexcept(FE_DIVBYZERO));
+        feclearexcept(FE_DIVBYZERO);
+        check(!fetestexcept(FE_DIVBYZERO));
+        r = one / one;
+        check(!fetestexcept(FE_DIVBYZERO));
+        check(r == 1.0);
+    }
+#endif
+}
+
+/* The same expression over memory that is written through an alias */
+static uint32_t __attribute__((noinline)) sum_twice(uint32_t *p, uint32_t *q)
+{
+    uint32_t a = p[0] * 3 + p[1];
+    q[0] = a;
+    return a + (p[0] * 3 + p[1]);
+}
+
+static void test_memory(void)
+{
+    uint32_t buf[2] = { 5, 7 };
+
+    /* 22 + (22 * 3 + 7) */
+    check(sum_twice(buf, buf) == 95);
+    check(buf[0] == 22);
+
+    buf[0] = 5;
+    /* 22 + (5 * 3 + 22) */
+    check(sum_twice(buf, buf + 1) == 59);
+    check(buf[1] == 22);
+}
+
+/*
+ * Guest registers that live in TCG globals are written back before a
+ * guest load that may fault.  Those stores must stay even if the same
+ * register is written again after the load.
+ */
+static sigjmp_buf fault_env;
+
+static void fault_handler(int sig)
+{
+    siglongjmp(fault_env, 1);
+}
+
+static void test_fault(void)
+{
+    volatile uint32_t *volatile bad = (volatile uint32_t *)(uintptr_t)8;
+    volatile uint32_t x = 1, y = 2;
+    struct sigaction sa;
+
+    memset(&sa, 0, sizeof(sa));
+    sa.sa_handler = fault_handler;
+    sigaction(SIGSEGV, &sa, NULL);
+    sigaction(SIGBUS, &sa, NULL);
+
+    for (int i = 0; i < 4; i++) {
+        uint32_t a = x + y, b;
+
+        if (sigsetjmp(fault_env, 1) == 0) {
+            b = *bad;
+            x = b;
+            errors++;
+        } else {
+            b = x + y;
+        }
+        check(a == 3 && b == 3);
+    }
+
+    sa.sa_handler = SIG_DFL;
+    sigaction(SIGSEGV, &sa, NULL);
+    sigaction(SIGBUS, &sa, NULL);
+}
+
+/* Reads on either side of a barrier may see another thread's stores. */
+static uint32_t shared_data;
+static uint32_t shared_flag;
+
+static void *writer(void *arg)
+{
+    for (uint32_t i = 1; i <= 1000; i++) {
+        while (__atomic_load_n(&shared_flag, __ATOMIC_ACQUIRE) != 0) {
+            /* wait for the reader */
+        }
+        shared_data = i * 2;
+        __atomic_store_n(&shared_flag, i, __ATOMIC_RELEASE);
+    }
+    return NULL;
+}
+
+static void test_barriers(void)
+{
+    pthread_t thread;
+    uint32_t seen = 0;
+
+    pthread_create(&thread, NULL, writer, NULL);
+    while (seen < 1000) {
+        uint32_t f, d;
+
+        do {
+            __atomic_thread_fence(__ATOMIC_SEQ_CST);
+            f = *(volatile uint32_t *)&shared_flag;
+        } while (f == 0);
+        __atomic_thread_fence(__ATOMIC_ACQUIRE);
+        d = *(volatile uint32_t *)&shared_data;
+        check(f == seen + 1 && d == f * 2);
+        seen = f;
+        __atomic_store_n(&shared_flag, 0, __ATOMIC_RELEASE);
+    }
+    pthread_join(thread, NULL);
+}
+
+int main(void)
+{
+    test_helpers();
+    test_memory();
+    test_fault();
+    test_barriers();
+
+    if (errors) {
+        printf("FAIL: %d errors\n", errors);
+        return EXIT_FAILURE;
+    }
+    printf("PASS\n");
+    return EXIT_SUCCESS;
+}
@@ -0,0 +1,185 @@
+/*
+ * Unit-stride vector loads and stores across page boundaries
+ *
+ * Also faults on the second page: the elements before the faulting one
+ * are done, vstart points at it, and the access resumes from there once
+ * the handler made the page accessible.  vstart is read at the start of
+ * the handler, as linux-user does not save the vector state in the
+ * signal frame.
+ *
+ * SPDX-License-Identifier: GPL-2.0-or-later
+ */
+
+#include <assert.h>
+#include <signal.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/mman.h>
+#include <unistd.h>
+
+/* Copy n elements with vle<SEW>.v and vse<SEW>.v, like a vector memcpy */
+#define DEF_VCOPY(SEW)                                                  \
+static void vcopy##SEW(uint8_t *dst, const uint8_t *src, size_t n)      \
+{                                                                       \
+    while (n) {                                                         \
+        size_t vl;                                                      \
+        asm volatile("vsetvli %0, %1, e" #SEW ", m8, ta, ma\n\t"        \
+                     "vle" #SEW ".v v8, (%2)\n\t"                       \
+                     "vse" #SEW ".v v8, (%3)"                           \
+                     : "=&r"(vl) : "r"(n), "r"(src), "r"(dst)           \
+                     : "memory", "v8", "v9", "v10", "v11",              \
+                       "v12", "v13", "v14", "v15");                     \
+        src += vl * (SEW / 8);                                          \
+        dst += vl * (SEW / 8);                                          \
+        n -= vl;                                                        \
+    }                                                                   \
+}
+
+DEF_VCOPY(8)
+DEF_VCOPY(16)
+DEF_VCOPY(32)
+DEF_VCOPY(64)
+
+static void (*const vcopy[4])(uint8_t *, const uint8_t *, size_t) = {
+    vcopy8, vcopy16, vcopy32, vcopy64
+};
+
+static uint8_t *fault_page;
+static size_t fault_len;
+static int fault_prot;
+static int faults;
+static size_t fault_vstart;
+static uint8_t fault_before[64];
+
+static void segv_handler(int sig, siginfo_t *info, void *ctx)
+{
+    size_t vstart;
+
+    asm volatile("csrr %0, vstart" : "=r"(vstart));
+    fault_vstart = vstart;
+    memcpy(fault_before, fault_page - sizeof(fault_before),
+           sizeof(fault_before));
+    faults++;
+    assert(mprotect(fault_page, fault_len, fault_prot) == 0);
+}
+
+/*
+ * Copy n elements of 1 << esz bytes from start on, with the page after
+ * the first one of prot_page inaccessible.
+ */
+static void test_fault(uint8_t *dst, uint8_t *src, uint8_t *ref,
+                       uint8_t *prot_page, int prot, size_t page,
+                       int esz, size_t start, size_t n)
+{
+    size_t size = 1 << esz;
+    size_t len = 2 * page;
+
+    memset(dst, 0x5a, len);
+    memset(ref, 0x5a, len);
+    memcpy(ref + start, src + start, n * size);
+
+    fault_page = prot_page + page;
+    fault_len = page;
+    fault_prot = prot;
+    faults = 0;
+    fault_vstart = -1;
+    assert(mprotect(fault_page, page, PROT_NONE) == 0);
+
+    vcopy[esz](dst + start, src + start, n);
+
+    /* resumed at the element that crosses into or starts on the page */
+    assert(faults == 1);
+    assert(fault_vstart == (page - start) / size);
+    if (prot_page == dst) {
+        /* only the elements before the faulting one were stored */
+        size_t from = page - sizeof(fault_before);
+        size_t done = start + fault_vstart * size;
+
+        for (size_t i = from; i < page; i++) {
+            assert(fault_before[i - from] ==
+                   (i >= start && i < done ? src[i] : 0x5a));
+        }
+    }
+    assert(memcmp(dst, ref, len) == 0);
+}
+
+static void test_faults(size_t page)
+{
+    struct sigaction sa;
+    size_t len = 2 * page;
+    uint8_t *src = mmap(NULL, len, PROT_READ | PROT_WRITE,
+                        MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+    uint8_t *dst = mmap(NULL, len, PROT_READ | PROT_WRITE,
+                        MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+    uint8_t *ref = malloc(len);
+
+    assert(src != MAP_FAILED && dst != MAP_FAILED && ref != NULL);
+    for (size_t i = 0; i < len; i++) {
+        src[i] = i * 13 + (i >> 8);
+    }
+
+    memset(&sa, 0, sizeof(sa));
+    sa.sa_sigaction = segv_handler;
+    sa.sa_flags = SA_SIGINFO;
+    assert(sigaction(SIGSEGV, &sa, NULL) == 0);
+
+    for (int esz = 0; esz < 4; esz++) {
+        size_t size = 1 << esz;
+
+        /* 8 elements fit into v8-v15 at any VLEN and SEW */
+        for (size_t start = page - 4 * size; start <= page; start++) {
+            /* the load faults */
+            test_fault(dst, src, ref, src, PROT_READ | PROT_WRITE, page,
+                       esz, start, 8);
+            /* the store faults */
+            test_fault(dst, src, ref, dst, PROT_READ | PROT_WRITE, page,
+                       esz, start, 8);
+        }
+    }
+
+    sa.sa_handler = SIG_DFL;
+    sa.sa_flags = 0;
+    assert(sigaction(SIGSEGV, &sa, NULL) == 0);
+    munmap(src, len);
+    munmap(dst, len);
+    free(ref);
+}
+
+int main(void)
+{
+    size_t page = getpagesize();
+    size_t len = 3 * page;
+    uint8_t *src = mmap(NULL, len, PROT_READ | PROT_WRITE,
+                        MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+    uint8_t *dst = mmap(NULL, len, PROT_READ | PROT_WRITE,
+                        MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+    uint8_t *ref = mmap(NULL, len, PROT_READ | PROT_WRITE,
+                        MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+
+    assert(src != MAP_FAILED && dst != MAP_FAILED && ref != MAP_FAILED);
+    for (size_t i = 0; i < len; i++) {
+        src[i] = i * 7 + (i >> 8);
+    }
+
+    for (int esz = 0; esz < 4; esz++) {
+        size_t size = 1 << esz;
+
+        /* starting in the middle of an element crossing the page end, too */
+        for (size_t start = page - 4 * size; start < page + size; start++) {
+            for (size_t n = 1; n <= page / size + 3; n += 37) {
+                if (start + n * size > len) {
+                    break;
+                }
+                memset(dst, 0x5a, len);
+                memset(ref, 0x5a, len);
+                memcpy(ref + start, src + start, n * size);
+                vcopy[esz](dst + start, src + start, n);
+                assert(memcmp(dst, ref, len) == 0);
+            }
+        }
+    }
+
+    test_faults(page);
+    return 0;
+}